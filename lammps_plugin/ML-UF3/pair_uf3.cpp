@@ -18,6 +18,7 @@
  * ---------------------------------------------------------------------- */
 
 #include "pair_uf3.h"
+#include "uf3_binary_pot.h"
 #include "uf3_pair_bspline.h"
 #include "uf3_triplet_bspline.h"
 
@@ -28,10 +29,12 @@
 #include "math_const.h"
 #include "memory.h"
 #include "neigh_list.h"
+#include "neigh_request.h"
 #include "neighbor.h"
 #include "text_file_reader.h"
 
 #include <cmath>
+#include <cstring>
 
 using namespace LAMMPS_NS;
 using namespace MathConst;
@@ -42,27 +45,44 @@ PairUF3::PairUF3(LAMMPS *lmp) : Pair(lmp)
   restartinfo = 0;      // 1 if pair style writes restart info
   maxshort = 10;
   neighshort = nullptr;
+  rshort = nullptr;
+  delshort = nullptr;
+  ushort = nullptr;
+  ikshort = nullptr;
+  list_3b = nullptr;
+  persist_3b = 0;
+  pshort = pshort_start = pshort_num = nullptr;
+  maxpshort = maxpshort_ii = pshort_ready = 0;
   centroidstressflag = CENTROID_AVAIL;
   manybody_flag = 1;
   one_coeff = 0; //if 1 then allow only one coeff call of form 'pair_coeff * *'
                  //by setting it to 0 we will allow multiple 'pair_coeff' calls
   bsplines_created = 0;
+  keep_pot_data = 0;
+  build_3b_splines = 1;
+  layout_3b = uf3_triplet_bspline::LAYOUT_LINEAR;
+  precision_3b = uf3_triplet_bspline::PREC_DOUBLE;
+  storage_3b = uf3_triplet_bspline::STORE_DOUBLE;
 }
 
 PairUF3::~PairUF3()
 {
   if (copymode) return;
+  memory->destroy(pshort);
+  memory->destroy(pshort_start);
+  memory->destroy(pshort_num);
   if (allocated) {
     memory->destroy(setflag);
     memory->destroy(cutsq);
     memory->destroy(cut);
 
     if (pot_3b) {
-      memory->destroy(setflag_3b);
-      memory->destroy(cut_3b);
       memory->destroy(cut_3b_list);
-      memory->destroy(min_cut_3b);
       memory->destroy(neighshort);
+      memory->destroy(rshort);
+      memory->destroy(delshort);
+      memory->destroy(ushort);
+      memory->destroy(ikshort);
     }
   }
 }
@@ -74,7 +94,7 @@ PairUF3::~PairUF3()
 void PairUF3::settings(int narg, char **arg)
 {
 
-  if (narg != 2)
+  if (narg < 2)
     error->all(FLERR, "UF3: Invalid number of argument in pair settings\n\
             Are you running 2-body or 2 & 3-body UF potential\n\
             Also how many elements?");
@@ -97,6 +117,51 @@ number of elements detected by lammps in the structure are not same\n\
     tot_pot_files = n2body_pot_files + n3body_pot_files;
   } else
     error->all(FLERR, "UF3: UF3 not yet implemented for {}-body", nbody_flag);
+
+  // optional keywords
+
+  layout_3b = uf3_triplet_bspline::LAYOUT_LINEAR;
+  precision_3b = uf3_triplet_bspline::PREC_DOUBLE;
+  storage_3b = uf3_triplet_bspline::STORE_DOUBLE;
+  persist_3b = 0;
+  int iarg = 2;
+  while (iarg < narg) {
+    if (strcmp(arg[iarg], "layout") == 0) {
+      if (iarg + 2 > narg) error->all(FLERR, "Illegal pair_style uf3 command");
+      if (strcmp(arg[iarg + 1], "linear") == 0)
+        layout_3b = uf3_triplet_bspline::LAYOUT_LINEAR;
+      else if (strcmp(arg[iarg + 1], "blocked") == 0)
+        layout_3b = uf3_triplet_bspline::LAYOUT_BLOCKED;
+      else
+        error->all(FLERR, "UF3: Unknown layout {} in pair_style uf3 command", arg[iarg + 1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "persist") == 0) {
+      if (iarg + 2 > narg) error->all(FLERR, "Illegal pair_style uf3 command");
+      persist_3b = utils::logical(FLERR, arg[iarg + 1], false, lmp);
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "precision") == 0) {
+      if (iarg + 2 > narg) error->all(FLERR, "Illegal pair_style uf3 command");
+      if (strcmp(arg[iarg + 1], "double") == 0)
+        precision_3b = uf3_triplet_bspline::PREC_DOUBLE;
+      else if (strcmp(arg[iarg + 1], "mixed") == 0)
+        precision_3b = uf3_triplet_bspline::PREC_MIXED;
+      else
+        error->all(FLERR, "UF3: Unknown precision {} in pair_style uf3 command", arg[iarg + 1]);
+      iarg += 2;
+    } else if (strcmp(arg[iarg], "compress") == 0) {
+      if (iarg + 2 > narg) error->all(FLERR, "Illegal pair_style uf3 command");
+      if (strcmp(arg[iarg + 1], "none") == 0)
+        storage_3b = uf3_triplet_bspline::STORE_DOUBLE;
+      else if (strcmp(arg[iarg + 1], "fp32") == 0)
+        storage_3b = uf3_triplet_bspline::STORE_FLOAT;
+      else if (strcmp(arg[iarg + 1], "int16") == 0)
+        storage_3b = uf3_triplet_bspline::STORE_INT16;
+      else
+        error->all(FLERR, "UF3: Unknown compress {} in pair_style uf3 command", arg[iarg + 1]);
+      iarg += 2;
+    } else
+      error->all(FLERR, "UF3: Unknown pair_style uf3 keyword {}", arg[iarg]);
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -105,7 +170,17 @@ number of elements detected by lammps in the structure are not same\n\
 void PairUF3::coeff(int narg, char **arg)
 {
   if (!allocated) allocate();
-  
+
+  // optional trailing keyword selecting the 3-body representation
+  int tricubic = 0;
+  if (narg == 6 && utils::strmatch(arg[0], "3b")) {
+    if (strcmp(arg[5], "tricubic") == 0)
+      tricubic = 1;
+    else if (strcmp(arg[5], "bspline") != 0)
+      error->all(FLERR, "UF3: Unknown pair_coeff 3b keyword {}", arg[5]);
+    narg = 5;
+  }
+
   if (narg != 3 && narg != 5){
      /*error->warning(FLERR, "\nUF3: WARNING!! It seems that you are using the \n\
              older style of specifying UF3 POT files. This style of listing \n\
@@ -137,8 +212,6 @@ void PairUF3::coeff(int narg, char **arg)
       if (utils::strmatch(arg[0],".*\\*.*") || utils::strmatch(arg[1],".*\\*.*")){
         for (int i = ilo; i <= ihi; i++) {
           for (int j = MAX(jlo, i); j <= jhi; j++) {
-            if (comm->me == 0)
-              utils::logmesg(lmp, "\nUF3: Opening {} file\n", arg[2]);
             uf3_read_pot_file(i,j,arg[2]);
           }
         }
@@ -147,8 +220,6 @@ void PairUF3::coeff(int narg, char **arg)
       else{
         int i = utils::inumeric(FLERR, arg[0], true, lmp);
         int j = utils::inumeric(FLERR, arg[1], true, lmp);
-        if (comm->me == 0)
-          utils::logmesg(lmp, "\nUF3: Opening {} file\n", arg[2]);
         uf3_read_pot_file(i,j,arg[2]);
       }
     }
@@ -158,24 +229,32 @@ void PairUF3::coeff(int narg, char **arg)
         error->all(FLERR, "UF3: Invalid argument. For 3-body the first argument\n\
                 argument to pair_coeff needs to be 3b.\n\
                 Example pair_coeff 3b 1 2 2 A_B_B.");
+      if (!pot_3b)
+        error->all(FLERR, "UF3: 3-body pair_coeff needs pair_style uf3 3");
       if (utils::strmatch(arg[1],".*\\*.*") || utils::strmatch(arg[2],".*\\*.*") || utils::strmatch(arg[3],".*\\*.*")){
         for (int i = ilo; i <= ihi; i++) {
           for (int j = jlo; j <= jhi; j++) {
             for (int k = MAX(klo, jlo); k <= khi; k++) {
-              if (comm->me == 0)
-                utils::logmesg(lmp, "\nUF3: Opening {} file\n", arg[4]);
+              if (strcmp(arg[4], "none") == 0) {
+                uf3_no_3b(i,j,k);
+                continue;
+              }
               uf3_read_pot_file(i,j,k,arg[4]);
+              interactions_3b[id_3b(i,j,k)].tricubic = tricubic;
             }
           }
         }
       }
       else{
-        if (comm->me == 0)
-          utils::logmesg(lmp, "\nUF3: Opening {} file\n", arg[4]);
         int i = utils::inumeric(FLERR, arg[1], true, lmp);
         int j = utils::inumeric(FLERR, arg[2], true, lmp);
         int k = utils::inumeric(FLERR, arg[3], true, lmp);
-        uf3_read_pot_file(i,j,k,arg[4]);
+        if (strcmp(arg[4], "none") == 0)
+          uf3_no_3b(i,j,k);
+        else {
+          uf3_read_pot_file(i,j,k,arg[4]);
+          interactions_3b[id_3b(i,j,k)].tricubic = tricubic;
+        }
       }
     }
   }
@@ -251,190 +330,231 @@ void PairUF3::allocate()
   //1 = non-uniform knot spacing
   memory->create(knot_spacing_type_2b, num_of_elements + 1, num_of_elements + 1, "pair:knot_spacing_2b");
 
-  // Contains knot_vect of 2-body potential for type i and j
-  n2b_knot.resize(num_of_elements + 1);
-  n2b_coeff.resize(num_of_elements + 1);
+  // Contains the potential data and the spline of the 2-body potential for type i and j
+  pot_data_2b.resize(num_of_elements + 1);
   UFBS2b.resize(num_of_elements + 1);
   for (int i = 1; i < num_of_elements + 1; i++) {
-    n2b_knot[i].resize(num_of_elements + 1);
-    n2b_coeff[i].resize(num_of_elements + 1);
+    pot_data_2b[i].resize(num_of_elements + 1);
     UFBS2b[i].resize(num_of_elements + 1);
   }
   if (pot_3b) {
-    // Contains info about wether UF potential were found for type i, j and k
-    memory->create(setflag_3b, num_of_elements + 1, num_of_elements + 1, num_of_elements + 1,
-                   "pair:setflag_3b");
-    // Contains info about 3-body cutoff distance for type i, j and k
-    memory->create(cut_3b, num_of_elements + 1, num_of_elements + 1, num_of_elements + 1,
-                   "pair:cut_3b");
-    // Contains info about 3-body cutoff distance for type i, j and k
+    // Contains info about 3-body cutoff distance for type i and j
     // for constructing 3-body list
     memory->create(cut_3b_list, num_of_elements + 1, num_of_elements + 1, "pair:cut_3b_list");
-    // Contains info about minimum 3-body cutoff distance for type i, j and k
-    memory->create(min_cut_3b, num_of_elements + 1, num_of_elements + 1, num_of_elements + 1, 3,
-                    "pair:min_cut_3b");
-  //Contains info about type of knot_spacing--> 0 = uniform knot spacing (default)
-  //1 = non-uniform knot spacing
-  memory->create(knot_spacing_type_3b, num_of_elements + 1, num_of_elements + 1,
-          num_of_elements + 1, "pair:knot_spacing_3b");
-
-
-    // setting cut_3b and setflag = 0
-    for (int i = 1; i < num_of_elements + 1; i++) {
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        cut_3b_list[i][j] = 0;
-        for (int k = 1; k < num_of_elements + 1; k++) {
-          cut_3b[i][j][k] = 0;
-          min_cut_3b[i][j][k][0] = 0;
-          min_cut_3b[i][j][k][1] = 0;
-          min_cut_3b[i][j][k][2] = 0;
+    for (int i = 1; i < num_of_elements + 1; i++)
+      for (int j = 1; j < num_of_elements + 1; j++) cut_3b_list[i][j] = 0;
+
+    // one interaction per i and j <= k, indexed by both orders of j and k
+    const int ntp = num_of_elements + 1;
+    index_3b.assign(ntp * ntp * ntp, -1);
+    int id = 0;
+    for (int i = 1; i < ntp; i++)
+      for (int j = 1; j < ntp; j++)
+        for (int k = j; k < ntp; k++) {
+          index_3b[(i * ntp + j) * ntp + k] = id;
+          index_3b[(i * ntp + k) * ntp + j] = id++;
         }
-      }
-    }
-    n3b_knot_matrix.resize(num_of_elements + 1);
-    UFBS3b.resize(num_of_elements + 1);
-    for (int i = 1; i < num_of_elements + 1; i++) {
-      n3b_knot_matrix[i].resize(num_of_elements + 1);
-      UFBS3b[i].resize(num_of_elements + 1);
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        n3b_knot_matrix[i][j].resize(num_of_elements + 1);
-        UFBS3b[i][j].resize(num_of_elements + 1);
-      }
-    }
+    interactions_3b.assign(id, uf3_interaction_3b());
     memory->create(neighshort, maxshort, "pair:neighshort");
+    memory->create(rshort, maxshort, "pair:rshort");
+    memory->create(delshort, maxshort, 3, "pair:delshort");
+    memory->create(ushort, maxshort, 3, "pair:ushort");
+    memory->create(ikshort, maxshort, "pair:ikshort");
+    short_start.resize(num_of_elements + 2);
+    ikshort_jtype.resize(num_of_elements + 1);
+    slab_3b.resize(num_of_elements + 1);
+    slab_state_3b.resize(num_of_elements + 1);
   }
 }
 
+/* ----------------------------------------------------------------------
+   set the 2-body interaction itype-jtype from potf_name
+------------------------------------------------------------------------- */
+
 void PairUF3::uf3_read_pot_file(int itype, int jtype, char *potf_name)
 {
   utils::logmesg(lmp, "UF3: {} file should contain UF3 potential for {} {}\n", \
           potf_name, itype, jtype);
 
-  if (!platform::file_is_readable(potf_name))
-    error->all(FLERR, "UF3: {} file is not readable", potf_name);
+  std::shared_ptr<const uf3_pot_data> data = read_pot_data(potf_name);
+  const uf3_pot_data &pot = *data;
+  if (pot.nbody != 2)
+    error->all(FLERR, "UF3: Expected a 2B UF3 file but found {}B in {}", pot.nbody, potf_name);
 
-  FILE *fp;
-  fp = utils::open_potential(potf_name, lmp, nullptr);
+  knot_spacing_type_2b[itype][jtype] = pot.knot_spacing;
+  knot_spacing_type_2b[jtype][itype] = pot.knot_spacing;
 
-  TextFileReader txtfilereader(fp, "UF3:POTFP");
-  txtfilereader.ignore_comments = false;
+  //cut is used in init_one which is called by pair.cpp at line 267 where the return of init_one is squared
+  cut[itype][jtype] = pot.cut[0];
+  cut[jtype][itype] = cut[itype][jtype];
 
-  std::string temp_line = txtfilereader.next_line(1);
-  Tokenizer file_header(temp_line);
-  
-  if (file_header.count() != 2)
-    error->all(FLERR, "UF3: Expected only two words on 1st line of {} but found \n\
-            {} word/s",potf_name,file_header.count());
+  pot_data_2b[itype][jtype].pot = data;
+  pot_data_2b[jtype][itype].pot = data;
 
-  if (file_header.contains("#UF3 POT") == 0)
-    error->all(FLERR, "UF3: {} file is not UF3 POT type, 1st line of UF3 POT \n\
-            files contain '#UF3 POT'. Found {} in the header",potf_name,temp_line);
+  setflag[itype][jtype] = 1;
+  setflag[jtype][itype] = 1;
+}
 
-  temp_line = txtfilereader.next_line(1);
-  ValueTokenizer fp2nd_line(temp_line);
+/* ----------------------------------------------------------------------
+   set the 3-body interactions itype-jtype-ktype and itype-ktype-jtype
+   from potf_name
+------------------------------------------------------------------------- */
 
-  if (fp2nd_line.count() != 4)
-    error->all(FLERR, "UF3: Expected 4 words on 2nd line =>\n\
-            nBody leading_trim trailing_trim type_of_knot_spacing\n\
-            Found {}",temp_line);
-   
-  std::string nbody_on_file = fp2nd_line.next_string();
-  if (utils::strmatch(nbody_on_file,"2B"))
-    utils::logmesg(lmp, "UF3: File {} contains 2-body UF3 potential\n",potf_name);
-  else
-    error->all(FLERR, "UF3: Expected a 2B UF3 file but found {}",
-            nbody_on_file);
+void PairUF3::uf3_read_pot_file(int itype, int jtype, int ktype, char *potf_name)
+{
+  utils::logmesg(lmp, "UF3: {} file should contain UF3 potential for {} {} {}\n",
+          potf_name, itype, jtype, ktype);
 
-  int leading_trim = fp2nd_line.next_int();
-  int trailing_trim = fp2nd_line.next_int();
-  if (leading_trim != 0)
-    error->all(FLERR, "UF3: Current implementation is throughly tested only for\n\
-            leading_trim=0\n");
-  if (trailing_trim != 3)
-    error->all(FLERR, "UF3: Current implementation is throughly tested only for\n\
-            trailing_trim=3\n");
-  
-  std::string knot_type = fp2nd_line.next_string();
-  if (utils::strmatch(knot_type,"uk")){
-    utils::logmesg(lmp, "UF3: File {} contains 2-body UF3 potential with uniform\n\
-              knot spacing\n",potf_name);
-    knot_spacing_type_2b[itype][jtype] = 0;
-    knot_spacing_type_2b[jtype][itype] = 0;
-  }   
-  else if (utils::strmatch(knot_type,"nk")){
-    utils::logmesg(lmp, "UF3: File {} contains 2-body UF3 potential with non-uniform\n\
-            knot spacing\n",potf_name);
-    knot_spacing_type_2b[itype][jtype] = 1;
-    knot_spacing_type_2b[jtype][itype] = 1;
-    /*error->all(FLERR, "UF3: Current implementation only works with uniform\n\
-            knot spacing");*/
+  std::shared_ptr<const uf3_pot_data> data = read_pot_data(potf_name);
+  const uf3_pot_data &pot = *data;
+  if (pot.nbody != 3)
+    error->all(FLERR, "UF3: Expected a 3B UF3 file but found {}B in {}", pot.nbody, potf_name);
+
+  double cut3b_rjk = pot.cut[0];
+  double cut3b_rik = pot.cut[1];
+  double cut3b_rij = pot.cut[2];
+
+  // j and k of the same type are interchangeable, which needs rij=rik.
+  // rjk can be anything, triplets beyond it are skipped
+  if ((jtype == ktype) && (cut3b_rij != cut3b_rik))
+    error->all(FLERR, "UF3: {} has rij!=rik, which is only supported for j and k of \n\
+            different types", potf_name);
+
+  // the splines are built by several threads in create_bsplines(), which
+  // cannot report errors
+  for (int a = 0; a < 3; a++)
+    if (pot.knots[a].size() < 8)
+      error->all(FLERR, "UF3: {} needs at least 8 knots per dimension", potf_name);
+
+  // the interaction is stored for jtype <= ktype, a file for jtype > ktype
+  // has its ik and ij axes swapped. knots, cut and min_cut are ordered
+  // jk ik ij
+  uf3_interaction_3b &inter = interactions_3b[id_3b(itype, jtype, ktype)];
+  const int swapped = (jtype > ktype) ? 1 : 0;
+  inter.set = 1;
+  inter.knot_spacing = pot.knot_spacing;
+  inter.pot.pot = data;
+  inter.pot.swapped = swapped;
+  for (int a = 0; a < 3; a++) {
+    const int b = (swapped && a) ? 3 - a : a;
+    inter.cut[a] = pot.cut[b];
+    inter.min_cut[a] = pot.knots[b][0];
   }
-  else
-    error->all(FLERR, "UF3: Expected either 'uk'(uniform-knots) or 'nk'(non-uniform knots)\n\
-            Found {} on the 2nd line of {} pot file",knot_type,potf_name);
+  set_cut_3b_list(itype);
 
-  temp_line = txtfilereader.next_line(1);
-  ValueTokenizer fp3rd_line(temp_line);
-  if (fp3rd_line.count() != 2)
-    error->all(FLERR, "UF3: Expected only 2 numbers on 3rd line =>\n\
-            Rij_CUTOFF NUM_OF_KNOTS\n\
-            Found {} number/s",fp3rd_line.count());
-  
-  //cut is used in init_one which is called by pair.cpp at line 267 where the return of init_one is squared
-  cut[itype][jtype] = fp3rd_line.next_double();
-  cut[jtype][itype] = cut[itype][jtype];
+  if (comm->me == 0)
+    utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{} jk={} ik={} ij={}\n", potf_name, itype,
+                   jtype, ktype, pot.knots[0][0], pot.knots[1][0], pot.knots[2][0]);
+}
 
-  int num_knots_2b = fp3rd_line.next_int();
+/* ----------------------------------------------------------------------
+   declare that itype-jtype-ktype and itype-ktype-jtype have no 3-body term.
+   their triplets are skipped, and jtype neighbors of itype atoms only
+   enter the 3-body short list if another interaction needs them
+------------------------------------------------------------------------- */
 
-  temp_line = txtfilereader.next_line(num_knots_2b);
-  ValueTokenizer fp4th_line(temp_line);
-  
-  if (fp4th_line.count() != num_knots_2b)
-      error->all(FLERR, "UF3: Expected {} numbers on 4th line but found {} numbers",
-              num_knots_2b,fp4th_line.count());
-
-  n2b_knot[itype][jtype].resize(num_knots_2b);
-  n2b_knot[jtype][itype].resize(num_knots_2b);
-  for (int k = 0; k < num_knots_2b; k++) {
-    n2b_knot[itype][jtype][k] = fp4th_line.next_double();
-    n2b_knot[jtype][itype][k] = n2b_knot[itype][jtype][k];
-  }
+void PairUF3::uf3_no_3b(int itype, int jtype, int ktype)
+{
+  utils::logmesg(lmp, "UF3: No 3-body interaction for {} {} {}\n", itype, jtype, ktype);
+  uf3_interaction_3b &inter = interactions_3b[id_3b(itype, jtype, ktype)];
+  inter = uf3_interaction_3b();
+  inter.set = -1;
+  set_cut_3b_list(itype);
+}
 
-  temp_line = txtfilereader.next_line(1);
-  ValueTokenizer fp5th_line(temp_line);
-  int num_of_coeff_2b = fp5th_line.next_int();
+/* ----------------------------------------------------------------------
+   3-body list cutoffs of itype, the largest ij and ik cutoff of every type
+   over the interactions of itype
+------------------------------------------------------------------------- */
 
-  temp_line = txtfilereader.next_line(num_of_coeff_2b);
-  ValueTokenizer fp6th_line(temp_line);
+void PairUF3::set_cut_3b_list(int itype)
+{
+  for (int j = 1; j < num_of_elements + 1; j++) cut_3b_list[itype][j] = 0;
+  for (int j = 1; j < num_of_elements + 1; j++)
+    for (int k = j; k < num_of_elements + 1; k++) {
+      const uf3_interaction_3b &inter = interactions_3b[id_3b(itype, j, k)];
+      cut_3b_list[itype][j] = std::max(cut_3b_list[itype][j], inter.cut[2]);
+      cut_3b_list[itype][k] = std::max(cut_3b_list[itype][k], inter.cut[1]);
+    }
+}
 
-  if (fp6th_line.count() != num_of_coeff_2b)
-    error->all(FLERR, "UF3: Expected {} numbers on 6th line but found {} numbers",
-            num_of_coeff_2b, fp6th_line.count());
+/* ----------------------------------------------------------------------
+   content of potf_name. every file is read once on rank 0, either as text
+   or as binary file, and broadcast. wildcards and files used in several
+   pair_coeff commands share it, the cache is dropped when the splines are
+   created
+------------------------------------------------------------------------- */
 
-  n2b_coeff[itype][jtype].resize(num_of_coeff_2b);
-  n2b_coeff[jtype][itype].resize(num_of_coeff_2b);
-  for (int k = 0; k < num_of_coeff_2b; k++) {
-    n2b_coeff[itype][jtype][k] = fp6th_line.next_double();
-    n2b_coeff[jtype][itype][k] = n2b_coeff[itype][jtype][k];
-  }
-  
-  if (n2b_knot[itype][jtype].size() != n2b_coeff[itype][jtype].size() + 4) {
-    error->all(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
-               potf_name);
+std::shared_ptr<const PairUF3::uf3_pot_data> PairUF3::read_pot_data(const std::string &potf_name)
+{
+  auto cached = pot_cache.find(potf_name);
+  if (cached != pot_cache.end()) return cached->second;
+
+  auto data = std::make_shared<uf3_pot_data>();
+  uf3_pot_data &pot = *data;
+  if (comm->me == 0) {
+    utils::logmesg(lmp, "\nUF3: Opening {} file\n", potf_name);
+    if (!platform::file_is_readable(potf_name))
+      error->one(FLERR, "UF3: {} file is not readable", potf_name);
+
+    std::string potf_path = utils::get_potential_file_path(potf_name);
+    if (uf3_binary_pot::is_binary(potf_path))
+      read_pot_binary(potf_path, pot);
+    else
+      read_pot_text(potf_name, pot);
   }
-  setflag[itype][jtype] = 1;
-  setflag[jtype][itype] = 1;
+  bcast_pot_data(pot);
+  pot_cache[potf_name] = data;
+  return data;
 }
 
+/* ---------------------------------------------------------------------- */
 
-void PairUF3::uf3_read_pot_file(int itype, int jtype, int ktype, char *potf_name)
+void PairUF3::bcast_pot_data(uf3_pot_data &pot)
 {
-  utils::logmesg(lmp, "UF3: {} file should contain UF3 potential for {} {} {}\n",
-          potf_name, itype, jtype, ktype);
+  const int naxes = 3;
+  int sizes[2 + 2 * naxes + 1];
+  if (comm->me == 0) {
+    sizes[0] = pot.nbody;
+    sizes[1] = pot.knot_spacing;
+    for (int a = 0; a < naxes; a++) {
+      sizes[2 + a] = pot.shape[a];
+      sizes[2 + naxes + a] = pot.knots[a].size();
+    }
+    sizes[2 + 2 * naxes] = pot.coeff.size();
+  }
+  MPI_Bcast(sizes, 2 + 2 * naxes + 1, MPI_INT, 0, world);
+  MPI_Bcast(pot.cut, naxes, MPI_DOUBLE, 0, world);
+
+  // the knot vectors are sent in one piece
+  std::vector<double> knots;
+  if (comm->me == 0)
+    for (int a = 0; a < naxes; a++) knots.insert(knots.end(), pot.knots[a].begin(), pot.knots[a].end());
+  else
+    knots.resize(sizes[2 + naxes] + sizes[3 + naxes] + sizes[4 + naxes]);
+  MPI_Bcast(knots.data(), knots.size(), MPI_DOUBLE, 0, world);
+
+  pot.coeff.resize(sizes[2 + 2 * naxes]);
+  MPI_Bcast(pot.coeff.data(), pot.coeff.size(), MPI_DOUBLE, 0, world);
+
+  if (comm->me != 0) {
+    pot.nbody = sizes[0];
+    pot.knot_spacing = sizes[1];
+    auto first = knots.begin();
+    for (int a = 0; a < naxes; a++) {
+      pot.shape[a] = sizes[2 + a];
+      pot.knots[a].assign(first, first + sizes[2 + naxes + a]);
+      first += sizes[2 + naxes + a];
+    }
+  }
+}
 
-  if (!platform::file_is_readable(potf_name))
-    error->all(FLERR, "UF3: {} file is not readable", potf_name);
+/* ----------------------------------------------------------------------
+   parse a '#UF3 POT' text file, on rank 0 only
+------------------------------------------------------------------------- */
 
+void PairUF3::read_pot_text(const std::string &potf_name, uf3_pot_data &pot)
+{
   FILE *fp;
   fp = utils::open_potential(potf_name, lmp, nullptr);
 
@@ -443,464 +563,260 @@ void PairUF3::uf3_read_pot_file(int itype, int jtype, int ktype, char *potf_name
 
   std::string temp_line = txtfilereader.next_line(1);
   Tokenizer file_header(temp_line);
-  
+
   if (file_header.count() != 2)
-    error->all(FLERR, "UF3: Expected only two words on 1st line of {} but found \n\
+    error->one(FLERR, "UF3: Expected only two words on 1st line of {} but found \n\
             {} word/s",potf_name,file_header.count());
 
   if (file_header.contains("#UF3 POT") == 0)
-    error->all(FLERR, "UF3: {} file is not UF3 POT type, 1st line of UF3 POT \n\
+    error->one(FLERR, "UF3: {} file is not UF3 POT type, 1st line of UF3 POT \n\
             files contain '#UF3 POT'. Found {} in the header",potf_name,temp_line);
 
   temp_line = txtfilereader.next_line(1);
   ValueTokenizer fp2nd_line(temp_line);
 
   if (fp2nd_line.count() != 4)
-    error->all(FLERR, "UF3: Expected 3 words on 2nd line =>\n\
+    error->one(FLERR, "UF3: Expected 4 words on 2nd line =>\n\
             nBody leading_trim trailing_trim type_of_knot_spacing\n\
             Found {}",temp_line);
 
   std::string nbody_on_file = fp2nd_line.next_string();
-
-  if (utils::strmatch(nbody_on_file,"3B"))
-    utils::logmesg(lmp, "UF3: File {} contains 3-body UF3 potential\n",potf_name);
+  if (utils::strmatch(nbody_on_file,"2B"))
+    pot.nbody = 2;
+  else if (utils::strmatch(nbody_on_file,"3B"))
+    pot.nbody = 3;
   else
-    error->all(FLERR, "UF3: Expected a 3B UF3 file but found {}",
+    error->one(FLERR, "UF3: Expected a 2B or 3B UF3 file but found {}",
             nbody_on_file);
+  utils::logmesg(lmp, "UF3: File {} contains {}-body UF3 potential\n",potf_name,pot.nbody);
 
   int leading_trim = fp2nd_line.next_int();
   int trailing_trim = fp2nd_line.next_int();
   if (leading_trim != 0)
-    error->all(FLERR, "UF3: Current implementation is throughly tested only for\n\
+    error->one(FLERR, "UF3: Current implementation is throughly tested only for\n\
             leading_trim=0\n");
   if (trailing_trim != 3)
-    error->all(FLERR, "UF3: Current implementation is throughly tested only for\n\
+    error->one(FLERR, "UF3: Current implementation is throughly tested only for\n\
             trailing_trim=3\n");
-  
+
   std::string knot_type = fp2nd_line.next_string();
   if (utils::strmatch(knot_type,"uk")){
-    utils::logmesg(lmp, "UF3: File {} contains 3-body UF3 potential with uniform\n\
-            knot spacing\n",potf_name);
-    knot_spacing_type_3b[itype][jtype][ktype] = 0;
-    knot_spacing_type_3b[itype][ktype][jtype] = 0;
+    utils::logmesg(lmp, "UF3: File {} contains UF3 potential with uniform\n\
+              knot spacing\n",potf_name);
+    pot.knot_spacing = 0;
   }
   else if (utils::strmatch(knot_type,"nk")){
-    utils::logmesg(lmp, "UF3: File {} contains 3-body UF3 potential with non-uniform\n\
+    utils::logmesg(lmp, "UF3: File {} contains UF3 potential with non-uniform\n\
             knot spacing\n",potf_name);
-    knot_spacing_type_3b[itype][jtype][ktype] = 1;
-    knot_spacing_type_3b[itype][ktype][jtype] = 1;
-    /*error->all(FLERR, "UF3: Current implementation only works with uniform\n\
-            knot spacing");*/
+    pot.knot_spacing = 1;
   }
   else
-    error->all(FLERR, "UF3: Expected either 'uk'(uniform-knots) or 'nk'(non-uniform knots)\n\
+    error->one(FLERR, "UF3: Expected either 'uk'(uniform-knots) or 'nk'(non-uniform knots)\n\
             Found {} on the 2nd line of {} pot file",knot_type,potf_name);
-  
-  temp_line = txtfilereader.next_line(6);
-  ValueTokenizer fp3rd_line(temp_line);
 
-  if (fp3rd_line.count() != 6)
-    error->all(FLERR, "UF3: Expected only 6 numbers on 3rd line =>\n\
-            Rjk_CUTOFF Rik_CUTOFF Rij_CUTOFF NUM_OF_KNOTS_JK NUM_OF_KNOTS_IK NUM_OF_KNOTS_IJ\n\
-            Found {} number/s",fp3rd_line.count());
-  
-  double cut3b_rjk = fp3rd_line.next_double();
-  double cut3b_rij = fp3rd_line.next_double();
-  double cut3b_rik = fp3rd_line.next_double();
-
-  if (cut3b_rij != cut3b_rik) {
-     error->all(FLERR, "UF3: rij!=rik, Current implementation only works for rij=rik");
+  // 2B: Rij_CUTOFF NUM_OF_KNOTS
+  // 3B: Rjk_CUTOFF Rik_CUTOFF Rij_CUTOFF NUM_OF_KNOTS_JK NUM_OF_KNOTS_IK NUM_OF_KNOTS_IJ
+  const int naxes = (pot.nbody == 2) ? 1 : 3;
+  temp_line = txtfilereader.next_line(2 * naxes);
+  ValueTokenizer fp3rd_line(temp_line);
+  if (fp3rd_line.count() != 2 * naxes)
+    error->one(FLERR, "UF3: Expected only {} numbers on 3rd line of {} =>\n\
+            cutoffs followed by the number of knots\n\
+            Found {} number/s", 2 * naxes, potf_name, fp3rd_line.count());
+
+  int num_knots[3];
+  for (int a = 0; a < naxes; a++) pot.cut[a] = fp3rd_line.next_double();
+  for (int a = 0; a < naxes; a++) num_knots[a] = fp3rd_line.next_int();
+
+  for (int a = 0; a < naxes; a++) {
+    temp_line = txtfilereader.next_line(num_knots[a]);
+    ValueTokenizer knot_line(temp_line);
+    if (knot_line.count() != num_knots[a])
+      error->one(FLERR, "UF3: Expected {} numbers on {}th line of {} but found {} numbers",
+              num_knots[a], 4 + a, potf_name, knot_line.count());
+    pot.knots[a].resize(num_knots[a]);
+    for (int i = 0; i < num_knots[a]; i++) pot.knots[a][i] = knot_line.next_double();
   }
 
-  if (2 * cut3b_rik != cut3b_rjk) {
-    error->all(FLERR, "UF3: 2rij=2rik!=rik, Current implementation only works \n\
-            for 2rij=2rik!=rik");
+  // 2B: NUM_OF_COEFF, 3B: SHAPE_OF_COEFF_MATRIX[I][J][K]
+  temp_line = txtfilereader.next_line(naxes);
+  ValueTokenizer shape_line(temp_line);
+  if (shape_line.count() != naxes)
+    error->one(FLERR, "UF3: Expected {} numbers on {}th line of {} but found {} numbers",
+            naxes, 4 + naxes, potf_name, shape_line.count());
+  for (int a = 0; a < naxes; a++) pot.shape[a] = shape_line.next_int();
+
+  // knots are listed jk ik ij, the tensor dimensions ij ik jk
+  for (int a = 0; a < naxes; a++)
+    if (pot.knots[a].size() != (size_t) pot.shape[naxes - 1 - a] + 3 + 1)
+      error->one(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
+              potf_name);
+
+  // one line of coefficients, with the 3B tensor one line per [I][J]
+  const int row_len = pot.shape[naxes - 1];
+  const int nrows = (pot.nbody == 2) ? 1 : pot.shape[0] * pot.shape[1];
+  pot.coeff.resize((size_t) nrows * row_len);
+  for (int row = 0; row < nrows; row++) {
+    temp_line = txtfilereader.next_line(row_len);
+    ValueTokenizer coeff_line(temp_line);
+    if (coeff_line.count() != row_len)
+      error->one(FLERR, "UF3: Expected {} numbers on {}th line of {} but found \n\
+              {} numbers", row_len, 5 + naxes + row, potf_name, coeff_line.count());
+    for (int k = 0; k < row_len; k++) pot.coeff[(size_t) row * row_len + k] = coeff_line.next_double();
   }
-  
-  cut_3b_list[itype][jtype] = std::max(cut3b_rij, cut_3b_list[itype][jtype]);
-  cut_3b_list[itype][ktype] = std::max(cut_3b_list[itype][ktype], cut3b_rik);
-  
-  cut_3b[itype][jtype][ktype] = cut3b_rij;
-  cut_3b[itype][ktype][jtype] = cut3b_rik;
-
-  int num_knots_3b_jk = fp3rd_line.next_int();
-  temp_line = txtfilereader.next_line(num_knots_3b_jk);
-  ValueTokenizer fp4th_line(temp_line);
-
-  if (fp4th_line.count() != num_knots_3b_jk)
-    error->all(FLERR, "UF3: Expected {} numbers on 4th line but found {} numbers",
-            num_knots_3b_jk, fp4th_line.count());
- 
-
-  n3b_knot_matrix[itype][jtype][ktype].resize(3);
-  n3b_knot_matrix[itype][ktype][jtype].resize(3);
-
-  n3b_knot_matrix[itype][jtype][ktype][0].resize(num_knots_3b_jk);
-  n3b_knot_matrix[itype][ktype][jtype][0].resize(num_knots_3b_jk);
-
-  for (int i = 0; i < num_knots_3b_jk; i++) {
-    n3b_knot_matrix[itype][jtype][ktype][0][i] = fp4th_line.next_double();
-    n3b_knot_matrix[itype][ktype][jtype][0][i] =
-        n3b_knot_matrix[itype][jtype][ktype][0][i];
-  }
-
-  min_cut_3b[itype][jtype][ktype][0] = n3b_knot_matrix[itype][jtype][ktype][0][0]; 
-                    //min_cut_3b[itype][jtype][ktype][0] --> cutoff for jk distance
-                    
-  min_cut_3b[itype][ktype][jtype][0] = n3b_knot_matrix[itype][ktype][jtype][0][0];
-  if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_jk={} {}-{}-{}_jk={}\n",
-              potf_name,itype,jtype,ktype,min_cut_3b[itype][jtype][ktype][0],
-              itype,ktype,jtype,min_cut_3b[itype][ktype][jtype][0]);
-
-  int num_knots_3b_ik = fp3rd_line.next_int();
-  temp_line = txtfilereader.next_line(num_knots_3b_ik);
-  ValueTokenizer fp5th_line(temp_line);
-
-  if (fp5th_line.count() != num_knots_3b_ik)
-    error->all(FLERR, "UF3: Expected {} numbers on 5th line but found {} numbers",
-            num_knots_3b_ik, fp5th_line.count());
-
-  n3b_knot_matrix[itype][jtype][ktype][1].resize(num_knots_3b_ik);
-  n3b_knot_matrix[itype][ktype][jtype][2].resize(num_knots_3b_ik);
-  for (int i = 0; i < num_knots_3b_ik; i++) {
-      n3b_knot_matrix[itype][jtype][ktype][1][i] = fp5th_line.next_double();
-      n3b_knot_matrix[itype][ktype][jtype][2][i] =
-          n3b_knot_matrix[itype][jtype][ktype][1][i];
-    }
-
-  min_cut_3b[itype][jtype][ktype][1] = n3b_knot_matrix[itype][jtype][ktype][1][0];
-                    //min_cut_3b[itype][jtype][ktype][1] --> cutoff for ik distance
-
-  min_cut_3b[itype][ktype][jtype][2] = n3b_knot_matrix[itype][ktype][jtype][2][0];
-  if (comm->me == 0)
-    utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_ik={} {}-{}-{}_ik={}\n",
-            potf_name,itype,jtype,ktype,min_cut_3b[itype][jtype][ktype][1],
-            itype,ktype,jtype,min_cut_3b[itype][ktype][jtype][2]);
-
-  int num_knots_3b_ij = fp3rd_line.next_int();
-  temp_line = txtfilereader.next_line(num_knots_3b_ij);
-  ValueTokenizer fp6th_line(temp_line);
-
-  if (fp6th_line.count() != num_knots_3b_ij)
-    error->all(FLERR, "UF3: Expected {} numbers on 6th line but found {} numbers",
-            num_knots_3b_ij, fp5th_line.count());
-
-  n3b_knot_matrix[itype][jtype][ktype][2].resize(num_knots_3b_ij);
-  n3b_knot_matrix[itype][ktype][jtype][1].resize(num_knots_3b_ij);
-  for (int i = 0; i < num_knots_3b_ij; i++) {
-    n3b_knot_matrix[itype][jtype][ktype][2][i] = fp6th_line.next_double();
-    n3b_knot_matrix[itype][ktype][jtype][1][i] = 
-        n3b_knot_matrix[itype][jtype][ktype][2][i];
-    }
-
-  min_cut_3b[itype][jtype][ktype][2] = n3b_knot_matrix[itype][jtype][ktype][2][0];
-                    //min_cut_3b[itype][jtype][ktype][2] --> cutoff for ij distance 
-  min_cut_3b[itype][ktype][jtype][1] = n3b_knot_matrix[itype][ktype][jtype][1][0];
-  if (comm->me == 0)
-    utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_ij={} {}-{}-{}_ij={}\n",
-            potf_name,itype,jtype,ktype,min_cut_3b[itype][jtype][ktype][2],
-            itype,ktype,jtype,min_cut_3b[itype][ktype][jtype][1]);
-
-  temp_line = txtfilereader.next_line(3);
-  ValueTokenizer fp7th_line(temp_line);
-
-  if (fp7th_line.count() != 3)
-    error->all(FLERR, "UF3: Expected 3 numbers on 7th line =>\n\
-           SHAPE_OF_COEFF_MATRIX[I][J][K] \n\
-           found {} numbers", fp7th_line.count());
-
-  coeff_matrix_dim1 = fp7th_line.next_int();
-  coeff_matrix_dim2 = fp7th_line.next_int();
-  coeff_matrix_dim3 = fp7th_line.next_int();
-
-  if (n3b_knot_matrix[itype][jtype][ktype][0].size() != coeff_matrix_dim3 + 3 + 1)
-    error->all(FLERR, "UF3: {} has incorrect knot (NUM_OF_KNOTS_JK) and \n\
-            coeff (coeff_matrix_dim3) data nknots!=ncoeffs + 3 +1", potf_name);
+}
 
-  if (n3b_knot_matrix[itype][jtype][ktype][1].size() != coeff_matrix_dim2 + 3 + 1) 
-    error->all(FLERR, "UF3: {} has incorrect knot (NUM_OF_KNOTS_IK) and \n\
-            coeff (coeff_matrix_dim2) data nknots!=ncoeffs + 3 +1",potf_name);
+/* ----------------------------------------------------------------------
+   map a binary potential file, see uf3_binary_pot.h, on rank 0 only
+------------------------------------------------------------------------- */
 
-  if (n3b_knot_matrix[itype][jtype][ktype][2].size() != coeff_matrix_dim1 + 3 + 1) 
-    error->all(FLERR, "UF3: {} has incorrect knot (NUM_OF_KNOTS_IJ) and \n\
-            coeff ()coeff_matrix_dim1 data nknots!=ncoeffs + 3 +1",potf_name);
+void PairUF3::read_pot_binary(const std::string &potf_name, uf3_pot_data &pot)
+{
+  uf3_binary_pot binpot(lmp, potf_name);
+  const uf3_binary_header &hdr = binpot.header();
+  utils::logmesg(lmp, "UF3: File {} contains binary {}-body UF3 potential\n", potf_name,
+                 hdr.nbody);
 
-  coeff_matrix_elements_len = coeff_matrix_dim3;
-  
-  std::string key = std::to_string(itype) + std::to_string(jtype) + std::to_string(ktype);
-  n3b_coeff_matrix[key].resize(coeff_matrix_dim1);
-
-  int line_count = 0;
-  for (int i = 0; i < coeff_matrix_dim1; i++) {
-    n3b_coeff_matrix[key][i].resize(coeff_matrix_dim2);
-    for (int j = 0; j < coeff_matrix_dim2; j++) {
-      temp_line = txtfilereader.next_line(coeff_matrix_elements_len);
-      ValueTokenizer coeff_line(temp_line);
-      n3b_coeff_matrix[key][i][j].resize(coeff_matrix_dim3);
-
-      if (coeff_line.count() != coeff_matrix_elements_len)
-        error->all(FLERR, "UF3: Expected {} numbers on {}th line but found \n\
-                {} numbers",coeff_matrix_elements_len, line_count+8, coeff_line.count());
-      for (int k = 0; k < coeff_matrix_dim3; k++) {
-        n3b_coeff_matrix[key][i][j][k] = coeff_line.next_double();
-      }
-      line_count += 1;
-    }
+  if (hdr.leading_trim != 0)
+    error->one(FLERR, "UF3: Current implementation is throughly tested only for\n\
+            leading_trim=0\n");
+  if (hdr.trailing_trim != 3)
+    error->one(FLERR, "UF3: Current implementation is throughly tested only for\n\
+            trailing_trim=3\n");
+  if (hdr.knot_spacing > 1)
+    error->one(FLERR, "UF3: {} has unknown knot spacing type {}", potf_name, hdr.knot_spacing);
+
+  pot.nbody = hdr.nbody;
+  pot.knot_spacing = hdr.knot_spacing;
+  const int naxes = (pot.nbody == 2) ? 1 : 3;
+  size_t ncoeff = 1;
+  for (int a = 0; a < naxes; a++) {
+    if (hdr.nknots[a] != hdr.shape[naxes - 1 - a] + 3 + 1)
+      error->one(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
+                 potf_name);
+    pot.cut[a] = hdr.cut[a];
+    pot.shape[a] = hdr.shape[a];
+    pot.knots[a].assign(binpot.knots(a), binpot.knots(a) + hdr.nknots[a]);
+    ncoeff *= hdr.shape[a];
   }
+  pot.coeff.assign(binpot.coeff(), binpot.coeff() + ncoeff);
+}
 
-  std::string key2 = std::to_string(itype) + std::to_string(ktype) + std::to_string(jtype);
-  n3b_coeff_matrix[key2].resize(coeff_matrix_dim2);
-  for (int j = 0; j < coeff_matrix_dim2; j++) {
-    n3b_coeff_matrix[key2][j].resize(coeff_matrix_dim1);
-    for (int i = 0; i < coeff_matrix_dim1; i++) {
-      n3b_coeff_matrix[key2][j][i].resize(coeff_matrix_dim3);
-    }
-  }
+/* ----------------------------------------------------------------------
+   init specific to this pair style
+------------------------------------------------------------------------- */
+void PairUF3::init_style()
+{
+  if (force->newton_pair == 0) error->all(FLERR, "UF3: Pair style requires newton pair on");
 
-  for (int i = 0; i < coeff_matrix_dim1; i++) {
-    for (int j = 0; j < coeff_matrix_dim2; j++) {
-      for (int k = 0; k < coeff_matrix_dim3; k++) {
-        n3b_coeff_matrix[key2][j][i][k] = n3b_coeff_matrix[key][i][j][k];
+  // half list for the 2-body term. the triplets need a full list, but only
+  // out to the largest 3-body list cutoff, which is usually much shorter
+  neighbor->add_request(this)->set_id(1);
+  if (pot_3b) {
+    double cutmax = 0.0, cutmax_3b = 0.0;
+    for (int i = 1; i < num_of_elements + 1; i++)
+      for (int j = 1; j < num_of_elements + 1; j++) {
+        cutmax = MAX(cutmax, cut[i][j]);
+        cutmax_3b = MAX(cutmax_3b, cut_3b_list[i][j]);
       }
-    }
+    auto req = neighbor->add_request(this, NeighConst::REQ_FULL);
+    req->set_id(2);
+    req->set_cutoff(MIN(cutmax, cutmax_3b));
   }
 
-  setflag_3b[itype][jtype][ktype] = 1;
-  setflag_3b[itype][ktype][jtype] = 1;
-
+  // the lists may have been rebuilt for a new run without advancing ago
+  pshort_ready = 0;
 }
 
-void PairUF3::uf3_read_pot_file(char *potf_name)
-{
-  if (comm->me == 0) utils::logmesg(lmp, "\nUF3: Opening {} file\n", potf_name);
-
-  FILE *fp;
-  fp = utils::open_potential(potf_name, lmp, nullptr);
-  // if (fp) error->all(FLERR,"UF3: {} file not found",potf_name);
-
-  TextFileReader txtfilereader(fp, "UF3:POTFP");
-  txtfilereader.ignore_comments = false;
-
-  std::string temp_line = txtfilereader.next_line(2);
-  Tokenizer fp1st_line(temp_line);
-
-  if (fp1st_line.contains("#UF3 POT") == 0)
-    error->all(FLERR, "UF3: {} file is not UF3 POT type, found type {} {} on the file", potf_name,
-               fp1st_line.next(), fp1st_line.next());
-
-  if (comm->me == 0)
-    utils::logmesg(lmp, "UF3: {} file is of type {} {}\n", potf_name, fp1st_line.next(),
-                   fp1st_line.next());
-
-  temp_line = txtfilereader.next_line(1);
-  Tokenizer fp2nd_line(temp_line);
-  if (fp2nd_line.contains("2B") == 1) {
-    temp_line = txtfilereader.next_line(4);
-    ValueTokenizer fp3rd_line(temp_line);
-    int temp_type1 = fp3rd_line.next_int();
-    int temp_type2 = fp3rd_line.next_int();
-    if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: {} file contains 2-body UF3 potential for {} {}\n", potf_name,
-                     temp_type1, temp_type2);
-
-    //cut is used in init_one which is called by pair.cpp at line 267 where the return of init_one is squared
-    cut[temp_type1][temp_type2] = fp3rd_line.next_double();
-    // if(comm->me==0) utils::logmesg(lmp,"UF3: Cutoff {}\n",cutsq[temp_type1][temp_type2]);
-    cut[temp_type2][temp_type1] = cut[temp_type1][temp_type2];
-
-    int temp_line_len = fp3rd_line.next_int();
-
-    temp_line = txtfilereader.next_line(temp_line_len);
-    ValueTokenizer fp4th_line(temp_line);
-
-    n2b_knot[temp_type1][temp_type2].resize(temp_line_len);
-    n2b_knot[temp_type2][temp_type1].resize(temp_line_len);
-    for (int k = 0; k < temp_line_len; k++) {
-      n2b_knot[temp_type1][temp_type2][k] = fp4th_line.next_double();
-      n2b_knot[temp_type2][temp_type1][k] = n2b_knot[temp_type1][temp_type2][k];
-    }
-
-    temp_line = txtfilereader.next_line(1);
-    ValueTokenizer fp5th_line(temp_line);
-
-    temp_line_len = fp5th_line.next_int();
-
-    temp_line = txtfilereader.next_line(temp_line_len);
-    // utils::logmesg(lmp,"UF3:11 {}",temp_line);
-    ValueTokenizer fp6th_line(temp_line);
-    // if(comm->me==0) utils::logmesg(lmp,"UF3: {}\n",temp_line_len);
-    n2b_coeff[temp_type1][temp_type2].resize(temp_line_len);
-    n2b_coeff[temp_type2][temp_type1].resize(temp_line_len);
-
-    for (int k = 0; k < temp_line_len; k++) {
-      n2b_coeff[temp_type1][temp_type2][k] = fp6th_line.next_double();
-      n2b_coeff[temp_type2][temp_type1][k] = n2b_coeff[temp_type1][temp_type2][k];
-      // if(comm->me==0) utils::logmesg(lmp,"UF3: {}\n",n2b_coeff[temp_type1][temp_type2][k]);
-    }
-    // for(int i=0;i<n2b_coeff[temp_type1][temp_type2].size();i++) if(comm->me==0) utils::logmesg(lmp,"UF3: {}\n",n2b_coeff[temp_type1][temp_type2][i]);
-    if (n2b_knot[temp_type1][temp_type2].size() != n2b_coeff[temp_type1][temp_type2].size() + 4) {
-      error->all(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
-                 potf_name);
-    }
-    setflag[temp_type1][temp_type2] = 1;
-    setflag[temp_type2][temp_type1] = 1;
-  } else if (fp2nd_line.contains("3B") == 1) {
-    temp_line = txtfilereader.next_line(9);
-    ValueTokenizer fp3rd_line(temp_line);
-    int temp_type1 = fp3rd_line.next_int();
-    int temp_type2 = fp3rd_line.next_int();
-    int temp_type3 = fp3rd_line.next_int();
-    if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: {} file contains 3-body UF3 potential for {} {} {}\n", potf_name,
-                     temp_type1, temp_type2, temp_type3);
-
-    double cut3b_rjk = fp3rd_line.next_double();
-    double cut3b_rij = fp3rd_line.next_double();
-    // cut_3b[temp_type1][temp_type2] = std::max(cut3b_rij,
-    // cut_3b[temp_type1][temp_type2]);
-    cut_3b_list[temp_type1][temp_type2] = std::max(cut3b_rij, cut_3b_list[temp_type1][temp_type2]);
-    double cut3b_rik = fp3rd_line.next_double();
-    if (cut3b_rij != cut3b_rik) {
-      error->all(FLERR, "UF3: rij!=rik, Current implementation only works for rij=rik");
-    }
-    if (2 * cut3b_rik != cut3b_rjk) {
-      error->all(FLERR,
-                 "UF3: 2rij=2rik!=rik, Current implementation only works for 2rij=2rik!=rik");
-    }
-    // cut_3b[temp_type1][temp_type3] = std::max(cut_3b[temp_type1][temp_type3],cut3b_rik);
-    cut_3b_list[temp_type1][temp_type3] = std::max(cut_3b_list[temp_type1][temp_type3], cut3b_rik);
-
-    cut_3b[temp_type1][temp_type2][temp_type3] = cut3b_rij;
-    cut_3b[temp_type1][temp_type3][temp_type2] = cut3b_rik;
-
-    int temp_line_len = fp3rd_line.next_int();
-    temp_line = txtfilereader.next_line(temp_line_len);
-    ValueTokenizer fp4th_line(temp_line);
-
-    n3b_knot_matrix[temp_type1][temp_type2][temp_type3].resize(3);
-    n3b_knot_matrix[temp_type1][temp_type3][temp_type2].resize(3);
-
-    n3b_knot_matrix[temp_type1][temp_type2][temp_type3][0].resize(temp_line_len);
-    n3b_knot_matrix[temp_type1][temp_type3][temp_type2][0].resize(temp_line_len);
-    for (int i = 0; i < temp_line_len; i++) {
-      n3b_knot_matrix[temp_type1][temp_type2][temp_type3][0][i] = fp4th_line.next_double();
-      n3b_knot_matrix[temp_type1][temp_type3][temp_type2][0][i] =
-          n3b_knot_matrix[temp_type1][temp_type2][temp_type3][0][i];
-    }
-
-    min_cut_3b[temp_type1][temp_type2][temp_type3][0] = n3b_knot_matrix[temp_type1][temp_type2][temp_type3][0][0];
-    min_cut_3b[temp_type1][temp_type3][temp_type2][0] = n3b_knot_matrix[temp_type1][temp_type3][temp_type2][0][0];
-    if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_0={} {}-{}-{}_0={}\n",
-              potf_name,temp_type1,temp_type2,temp_type3,min_cut_3b[temp_type1][temp_type2][temp_type3][0],
-              temp_type1,temp_type3,temp_type2,min_cut_3b[temp_type1][temp_type3][temp_type2][0]);
-
-    temp_line_len = fp3rd_line.next_int();
-    temp_line = txtfilereader.next_line(temp_line_len);
-    ValueTokenizer fp5th_line(temp_line);
-    n3b_knot_matrix[temp_type1][temp_type2][temp_type3][1].resize(temp_line_len);
-    n3b_knot_matrix[temp_type1][temp_type3][temp_type2][2].resize(temp_line_len);
-    for (int i = 0; i < temp_line_len; i++) {
-      n3b_knot_matrix[temp_type1][temp_type2][temp_type3][1][i] = fp5th_line.next_double();
-      n3b_knot_matrix[temp_type1][temp_type3][temp_type2][2][i] =
-          n3b_knot_matrix[temp_type1][temp_type2][temp_type3][1][i];
-    }
-
-    min_cut_3b[temp_type1][temp_type2][temp_type3][1] = n3b_knot_matrix[temp_type1][temp_type2][temp_type3][1][0];
-    min_cut_3b[temp_type1][temp_type3][temp_type2][2] = n3b_knot_matrix[temp_type1][temp_type3][temp_type2][2][0];
-    if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_1={} {}-{}-{}_2={}\n",
-              potf_name,temp_type1,temp_type2,temp_type3,min_cut_3b[temp_type1][temp_type2][temp_type3][1],
-              temp_type1,temp_type3,temp_type2,min_cut_3b[temp_type1][temp_type3][temp_type2][2]);
-
-    temp_line_len = fp3rd_line.next_int();
-    temp_line = txtfilereader.next_line(temp_line_len);
-    ValueTokenizer fp6th_line(temp_line);
-    n3b_knot_matrix[temp_type1][temp_type2][temp_type3][2].resize(temp_line_len);
-    n3b_knot_matrix[temp_type1][temp_type3][temp_type2][1].resize(temp_line_len);
-    for (int i = 0; i < temp_line_len; i++) {
-      n3b_knot_matrix[temp_type1][temp_type2][temp_type3][2][i] = fp6th_line.next_double();
-      n3b_knot_matrix[temp_type1][temp_type3][temp_type2][1][i] =
-          n3b_knot_matrix[temp_type1][temp_type2][temp_type3][2][i];
-    }
-
-    min_cut_3b[temp_type1][temp_type2][temp_type3][2] = n3b_knot_matrix[temp_type1][temp_type2][temp_type3][2][0];
-    min_cut_3b[temp_type1][temp_type3][temp_type2][1] = n3b_knot_matrix[temp_type1][temp_type3][temp_type2][1][0];
-    if (comm->me == 0)
-      utils::logmesg(lmp, "UF3: 3b min cutoff {} {}-{}-{}_2={} {}-{}-{}_1={}\n",
-              potf_name,temp_type1,temp_type2,temp_type3,min_cut_3b[temp_type1][temp_type2][temp_type3][2],
-              temp_type1,temp_type3,temp_type2,min_cut_3b[temp_type1][temp_type3][temp_type2][2]);
-
-    temp_line = txtfilereader.next_line(3);
-    ValueTokenizer fp7th_line(temp_line);
-
-    coeff_matrix_dim1 = fp7th_line.next_int();
-    coeff_matrix_dim2 = fp7th_line.next_int();
-    coeff_matrix_dim3 = fp7th_line.next_int();
-    if (n3b_knot_matrix[temp_type1][temp_type2][temp_type3][0].size() !=
-        coeff_matrix_dim3 + 3 + 1) {
-      error->all(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
-                 potf_name);
-    }
-    if (n3b_knot_matrix[temp_type1][temp_type2][temp_type3][1].size() !=
-        coeff_matrix_dim2 + 3 + 1) {
-      error->all(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
-                 potf_name);
-    }
-    if (n3b_knot_matrix[temp_type1][temp_type2][temp_type3][2].size() !=
-        coeff_matrix_dim1 + 3 + 1) {
-      error->all(FLERR, "UF3: {} has incorrect knot and coeff data nknots!=ncoeffs + 3 +1",
-                 potf_name);
-    }
+/* ----------------------------------------------------------------------
+   with the persist keyword the 3-body loop does not filter the 3-body list
+   every step. when the lists are built, collect_candidates_3b() keeps the
+   neighbors that can come within the 3-body list cutoffs before the next
+   build, grouped by type and sorted by distance, and the short lists are
+   filtered from them until then. they arrive almost sorted, so building
+   the short list is close to linear in the number of candidates.
+   the candidates of ilist[ii] start at pshort_start[ii], there is room
+   for all neighbors of the 3-body list.
+------------------------------------------------------------------------- */
 
-    coeff_matrix_elements_len = coeff_matrix_dim3;
-
-    std::string key =
-        std::to_string(temp_type1) + std::to_string(temp_type2) + std::to_string(temp_type3);
-    n3b_coeff_matrix[key].resize(coeff_matrix_dim1);
-    for (int i = 0; i < coeff_matrix_dim1; i++) {
-      n3b_coeff_matrix[key][i].resize(coeff_matrix_dim2);
-      for (int j = 0; j < coeff_matrix_dim2; j++) {
-        temp_line = txtfilereader.next_line(coeff_matrix_elements_len);
-        ValueTokenizer coeff_line(temp_line);
-        n3b_coeff_matrix[key][i][j].resize(coeff_matrix_dim3);
-        for (int k = 0; k < coeff_matrix_dim3; k++) {
-          n3b_coeff_matrix[key][i][j][k] = coeff_line.next_double();
-        }
-      }
-    }
+void PairUF3::setup_candidates_3b()
+{
+  const int inum = list_3b->inum;
+  const int *ilist = list_3b->ilist;
+  const int *numneigh = list_3b->numneigh;
+
+  if (inum > maxpshort_ii) {
+    maxpshort_ii = inum;
+    memory->destroy(pshort_start);
+    memory->destroy(pshort_num);
+    memory->create(pshort_start, maxpshort_ii, "pair:pshort_start");
+    memory->create(pshort_num, maxpshort_ii, "pair:pshort_num");
+  }
 
-    key = std::to_string(temp_type1) + std::to_string(temp_type3) + std::to_string(temp_type2);
-    n3b_coeff_matrix[key] =
-        n3b_coeff_matrix[std::to_string(temp_type1) + std::to_string(temp_type2) +
-                         std::to_string(temp_type3)];
-    setflag_3b[temp_type1][temp_type2][temp_type3] = 1;
-    setflag_3b[temp_type1][temp_type3][temp_type2] = 1;
-  } else
-    error->all(
-        FLERR,
-        "UF3: {} file does not contain right words indicating whether it is 2 or 3 body potential",
-        potf_name);
+  int n = 0;
+  for (int ii = 0; ii < inum; ii++) {
+    pshort_start[ii] = n;
+    pshort_num[ii] = 0;
+    n += numneigh[ilist[ii]];
+  }
+  if (n > maxpshort) {
+    maxpshort = n + n / 4;
+    memory->destroy(pshort);
+    memory->create(pshort, maxpshort, "pair:pshort");
+  }
+  pshort_ready = 1;
 }
 
 /* ----------------------------------------------------------------------
-   init specific to this pair style
+   store the jnum neighbors of i in jlist that are within the 3-body list
+   cutoffs plus the skin in cand, grouped by type and sorted by distance.
+   rcand is scratch, returns the number of candidates.
 ------------------------------------------------------------------------- */
-void PairUF3::init_style()
+
+int PairUF3::collect_candidates_3b(int i, const int *jlist, int jnum, int *cand,
+                                   std::vector<double> &rcand)
 {
-  if (force->newton_pair == 0) error->all(FLERR, "UF3: Pair style requires newton pair on");
-  // request a default neighbor list
-  neighbor->add_request(this, NeighConst::REQ_FULL);
+  double **x = atom->x;
+  int *type = atom->type;
+  const int itype = type[i];
+  const double skin = neighbor->skin;
+  if ((int) rcand.size() < jnum) rcand.resize(jnum);
+
+  int ncand = 0;
+  for (int jj = 0; jj < jnum; jj++) {
+    const int j = jlist[jj] & NEIGHMASK;
+    const int jtype = type[j];
+    const double delx = x[j][0] - x[i][0];
+    const double dely = x[j][1] - x[i][1];
+    const double delz = x[j][2] - x[i][2];
+    const double rsq = delx * delx + dely * dely + delz * delz;
+    const double cutpad = MIN(cut[itype][jtype], cut_3b_list[itype][jtype]) + skin;
+    if (rsq > cutpad * cutpad) continue;
+
+    int n = ncand;
+    while ((n > 0) &&
+           ((type[cand[n - 1]] > jtype) || ((type[cand[n - 1]] == jtype) && (rcand[n - 1] > rsq)))) {
+      cand[n] = cand[n - 1];
+      rcand[n] = rcand[n - 1];
+      n--;
+    }
+    cand[n] = j;
+    rcand[n] = rsq;
+    ncand++;
+  }
+  return ncand;
 }
 
 /* ----------------------------------------------------------------------
-   init list sets the pointer to full neighbour list requested in previous function
+   init list sets the pointers to the neighbour lists requested in init_style
 ------------------------------------------------------------------------- */
 
-void PairUF3::init_list(int /*id*/, class NeighList *ptr)
+void PairUF3::init_list(int id, class NeighList *ptr)
 {
-  list = ptr;
+  if (id == 2)
+    list_3b = ptr;
+  else
+    list = ptr;
 }
 
 /* ----------------------------------------------------------------------
@@ -919,6 +835,7 @@ double PairUF3::init_one(int i /*i*/, int /*j*/ j)
 void PairUF3::create_bsplines()
 {
   bsplines_created = 1;
+  pot_cache.clear();    // the interactions hold the data they need
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = 1; j < num_of_elements + 1; j++) {
       if (setflag[i][j] != 1)
@@ -930,42 +847,97 @@ void PairUF3::create_bsplines()
     for (int i = 1; i < num_of_elements + 1; i++) {
       for (int j = 1; j < num_of_elements + 1; j++) {
         for (int k = 1; k < num_of_elements + 1; k++) {
-          if (setflag_3b[i][j][k] != 1)
+          if (interactions_3b[id_3b(i, j, k)].set == 0)
             error->all(FLERR,"UF3: Not all 3-body UF potentials are set, \n\
-                    missing potential file for {}-{}-{} interaction", i, j, k);
+                    missing potential file or none for {}-{}-{} interaction", i, j, k);
         }
       }
     }
   }
 
+  bsplines_2b.clear();
+  bsplines_2b.reserve(num_of_elements * (num_of_elements + 1) / 2);
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = i; j < num_of_elements + 1; j++) {
-      UFBS2b[i][j] = uf3_pair_bspline(lmp, n2b_knot[i][j], n2b_coeff[i][j],
-              knot_spacing_type_2b[i][j]);
-      UFBS2b[j][i] = UFBS2b[i][j];
+      bsplines_2b.emplace_back(lmp, knots_2b(i, j), coeff_2b(i, j), knot_spacing_type_2b[i][j]);
+      UFBS2b[i][j] = UFBS2b[j][i] = &bsplines_2b.back();
     }
-    if (pot_3b) {
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        for (int k = j; k < num_of_elements + 1; k++) {
-          std::string key = std::to_string(i) + std::to_string(j) + std::to_string(k);
-          UFBS3b[i][j][k] = 
-              uf3_triplet_bspline(lmp, n3b_knot_matrix[i][j][k], n3b_coeff_matrix[key],
-                      knot_spacing_type_3b[i][j][k]);
-          std::string key2 = std::to_string(i) + std::to_string(k) + std::to_string(j);
-          UFBS3b[i][k][j] =
-              uf3_triplet_bspline(lmp, n3b_knot_matrix[i][k][j], n3b_coeff_matrix[key2],
-                      knot_spacing_type_3b[i][k][j]);
-        }
-      }
+  }
+
+  if (pot_3b && build_3b_splines) {
+    // the 3-body splines of the interactions are independent and are built
+    // by the threads. with a single spline the tricubic expansion in its
+    // constructor is threaded instead
+    std::vector<int> ids;
+    for (int id = 0; id < (int) interactions_3b.size(); id++)
+      if (interactions_3b[id].set == 1) ids.push_back(id);
+    const int nspline = ids.size();
+    bsplines_3b.clear();
+    bsplines_3b.resize(interactions_3b.size());
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(dynamic, 1) num_threads(comm->nthreads) if (nspline > 1)
+#endif
+    for (int t = 0; t < nspline; t++) {
+      const int id = ids[t];
+      const uf3_interaction_3b &inter = interactions_3b[id];
+      bsplines_3b[id] =
+          uf3_triplet_bspline(lmp, knots_3b(id, 0), knots_3b(id, 1), knots_3b(id, 2),
+                  coeff_3b(id), inter.knot_spacing, layout_3b,
+                  inter.tricubic ? uf3_triplet_bspline::REPR_TRICUBIC
+                                 : uf3_triplet_bspline::REPR_BSPLINE,
+                  precision_3b, storage_3b);
     }
   }
+
+  if (!keep_pot_data) release_pot_data();
+}
+
+/* ----------------------------------------------------------------------
+   the potential data of the 3-body interaction id in its stored order
+   i-j-k, jtype <= ktype
+------------------------------------------------------------------------- */
+
+const std::vector<double> &PairUF3::knots_3b(int id, int a) const
+{
+  const uf3_pot_ref &ref = interactions_3b[id].pot;
+  return ref.pot->knots[(ref.swapped && a) ? 3 - a : a];
+}
+
+uf3_tensor_view PairUF3::coeff_3b(int id) const
+{
+  const uf3_pot_ref &ref = interactions_3b[id].pot;
+  const int *shape = ref.pot->shape;
+  const size_t stride_ij = (size_t) shape[1] * shape[2];
+  const size_t stride_ik = shape[2];
+  uf3_tensor_view view;
+  view.data = ref.pot->coeff.data();
+  view.dim[0] = shape[ref.swapped ? 1 : 0];
+  view.dim[1] = shape[ref.swapped ? 0 : 1];
+  view.dim[2] = shape[2];
+  view.stride[0] = ref.swapped ? stride_ik : stride_ij;
+  view.stride[1] = ref.swapped ? stride_ij : stride_ik;
+  return view;
+}
+
+/* ----------------------------------------------------------------------
+   drop the parsed potential files once everything built from them exists.
+   only the splines, and the tables of the accelerated styles, are kept
+------------------------------------------------------------------------- */
+
+void PairUF3::release_pot_data()
+{
+  pot_cache.clear();
+  for (auto &row : pot_data_2b)
+    for (auto &ref : row) ref.pot.reset();
+  for (auto &inter : interactions_3b) inter.pot.pot.reset();
 }
 
 void PairUF3::compute(int eflag, int vflag)
 {
   int i, j, k, ii, jj, kk, inum, jnum, itype, jtype, ktype;
   double xtmp, ytmp, ztmp, delx, dely, delz, evdwl, fpair, fx, fy, fz;
-  double del_rji[3], del_rki[3], del_rkj[3];
+  double *del_rji, *del_rki, del_rkj[3];
   double fij[3], fik[3], fjk[3];
   double fji[3], fki[3], fkj[3];
   double Fi[3], Fj[3], Fk[3];
@@ -980,6 +952,9 @@ void PairUF3::compute(int eflag, int vflag)
   int nlocal = atom->nlocal;
   int newton_pair = force->newton_pair;
 
+  // 2-body interaction over the half list. the UF3 2-body energy is a sum
+  // over ordered pairs, so each pair of the half list is counted twice
+
   inum = list->inum;
   ilist = list->ilist;
   numneigh = list->numneigh;
@@ -994,7 +969,6 @@ void PairUF3::compute(int eflag, int vflag)
     itype = type[i];
     jlist = firstneigh[i];
     jnum = numneigh[i];
-    int numshort = 0;
     for (jj = 0; jj < jnum; jj++) {
       fx = 0;
       fy = 0;
@@ -1011,20 +985,10 @@ void PairUF3::compute(int eflag, int vflag)
       if (rsq < cutsq[itype][jtype]) {
         rij = sqrt(rsq);
 
-        if (pot_3b) {
-          if (rij <= cut_3b_list[itype][jtype]) {
-            neighshort[numshort] = j;
-            if (numshort >= maxshort - 1) {
-              maxshort += maxshort / 2;
-              memory->grow(neighshort, maxshort, "pair:neighshort");
-            }
-            numshort = numshort + 1;
-          }
-        }
-
-        double *pair_eval = UFBS2b[itype][jtype].eval(rij);
+        double pair_eval[2];
+        UFBS2b[itype][jtype]->eval(rij, pair_eval);
 
-        fpair = -1 * pair_eval[1] / rij;
+        fpair = -2 * pair_eval[1] / rij;
 
         fx = delx * fpair;
         fy = dely * fpair;
@@ -1037,7 +1001,7 @@ void PairUF3::compute(int eflag, int vflag)
         f[j][1] -= fy;
         f[j][2] -= fz;
 
-        if (eflag) evdwl = pair_eval[0];
+        if (eflag) evdwl = 2 * pair_eval[0];
 
         if (evflag) {
           ev_tally_xyz(i, j, nlocal, newton_pair, evdwl, 0.0, fx, fy, fz, delx, dely, delz);
@@ -1076,8 +1040,98 @@ void PairUF3::compute(int eflag, int vflag)
         }
       }
     }
+  }
+
+  if (!pot_3b) {
+    if (vflag_fdotr) virial_fdotr_compute();
+    return;
+  }
+
+  // 3-body interaction over the full list at the 3-body cutoffs, or over
+  // the candidates collected when it was built
+
+  const int rebuild_3b = persist_3b && ((neighbor->ago == 0) || !pshort_ready);
+  if (rebuild_3b) setup_candidates_3b();
+
+  inum = list_3b->inum;
+  ilist = list_3b->ilist;
+  numneigh = list_3b->numneigh;
+  firstneigh = list_3b->firstneigh;
+  for (ii = 0; ii < inum; ii++) {
+    evdwl = 0;
+    i = ilist[ii];
+    xtmp = x[i][0];
+    ytmp = x[i][1];
+    ztmp = x[i][2];
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (persist_3b) {
+      if (rebuild_3b)
+        pshort_num[ii] = collect_candidates_3b(i, jlist, jnum, pshort + pshort_start[ii], rcand_3b);
+      jlist = pshort + pshort_start[ii];
+      jnum = pshort_num[ii];
+    }
+
+    // short list of the neighbors within the 3-body list cutoff, grouped
+    // by type and sorted by distance within each group. the lists are
+    // short, so they are kept in order with an insertion sort
+    int numshort = 0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j][0];
+      dely = ytmp - x[j][1];
+      delz = ztmp - x[j][2];
+
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      if (rsq < cutsq[itype][jtype]) {
+        rij = sqrt(rsq);
+        if (rij > cut_3b_list[itype][jtype]) continue;
+        int n = numshort;
+        while ((n > 0) &&
+               ((type[neighshort[n - 1]] > jtype) ||
+                ((type[neighshort[n - 1]] == jtype) && (rshort[n - 1] > rij)))) {
+          neighshort[n] = neighshort[n - 1];
+          rshort[n] = rshort[n - 1];
+          n--;
+        }
+        neighshort[n] = j;
+        rshort[n] = rij;
+        if (numshort >= maxshort - 1) {
+          maxshort += maxshort / 2;
+          memory->grow(neighshort, maxshort, "pair:neighshort");
+          memory->grow(rshort, maxshort, "pair:rshort");
+          memory->grow(delshort, maxshort, 3, "pair:delshort");
+          memory->grow(ushort, maxshort, 3, "pair:ushort");
+          memory->grow(ikshort, maxshort, "pair:ikshort");
+        }
+        numshort = numshort + 1;
+      }
+    }
+
+    // start of the ktype group in the short list
+    int n = 0;
+    for (ktype = 1; ktype < num_of_elements + 2; ktype++) {
+      while ((n < numshort) && (type[neighshort[n]] < ktype)) n++;
+      short_start[ktype] = n;
+    }
+
+    // displacements and directions are shared by all triplets of i, the
+    // ik axes by the triplets of i with the same jtype and ktype
+    for (n = 0; n < numshort; n++) {
+      j = neighshort[n];
+      delshort[n][0] = x[j][0] - xtmp;
+      delshort[n][1] = x[j][1] - ytmp;
+      delshort[n][2] = x[j][2] - ztmp;
+      ushort[n][0] = delshort[n][0] / rshort[n];
+      ushort[n][1] = delshort[n][1] / rshort[n];
+      ushort[n][2] = delshort[n][2] / rshort[n];
+    }
+    for (ktype = 1; ktype < num_of_elements + 1; ktype++) ikshort_jtype[ktype] = 0;
 
-    // 3-body interaction
     // jth atom
     jnum = numshort - 1;
     for (jj = 0; jj < jnum; jj++) {
@@ -1086,135 +1140,166 @@ void PairUF3::compute(int eflag, int vflag)
       fij[2] = fji[2] = 0;
       j = neighshort[jj];
       jtype = type[j];
-      del_rji[0] = x[j][0] - xtmp;
-      del_rji[1] = x[j][1] - ytmp;
-      del_rji[2] = x[j][2] - ztmp;
-      rij =
-          sqrt(((del_rji[0] * del_rji[0]) + (del_rji[1] * del_rji[1]) + (del_rji[2] * del_rji[2])));
-
-      // kth atom
-      for (kk = jj + 1; kk < numshort; kk++) {
-
-        fik[0] = fki[0] = 0;
-        fik[1] = fki[1] = 0;
-        fik[2] = fki[2] = 0;
-
-        fjk[0] = fkj[0] = 0;
-        fjk[1] = fkj[1] = 0;
-        fjk[2] = fkj[2] = 0;
-
-        k = neighshort[kk];
-        ktype = type[k];
-        del_rki[0] = x[k][0] - xtmp;
-        del_rki[1] = x[k][1] - ytmp;
-        del_rki[2] = x[k][2] - ztmp;
-        rik = sqrt(
-            ((del_rki[0] * del_rki[0]) + (del_rki[1] * del_rki[1]) + (del_rki[2] * del_rki[2])));
-
-        if ((rij <= cut_3b[itype][jtype][ktype]) && (rik <= cut_3b[itype][ktype][jtype]) &&
-                (rij >= min_cut_3b[itype][jtype][ktype][2]) && 
-                (rik >= min_cut_3b[itype][jtype][ktype][1])) {
-
-          del_rkj[0] = x[k][0] - x[j][0];
-          del_rkj[1] = x[k][1] - x[j][1];
-          del_rkj[2] = x[k][2] - x[j][2];
-          rjk = sqrt(
-              ((del_rkj[0] * del_rkj[0]) + (del_rkj[1] * del_rkj[1]) + (del_rkj[2] * del_rkj[2])));
-
-          if (rjk >= min_cut_3b[itype][jtype][ktype][0]){
-            double *triangle_eval = UFBS3b[itype][jtype][ktype].eval(rij, rik, rjk);
-
-            fij[0] = *(triangle_eval + 1) * (del_rji[0] / rij);
-            fji[0] = -fij[0];
-            fik[0] = *(triangle_eval + 2) * (del_rki[0] / rik);
-            fki[0] = -fik[0];
-            fjk[0] = *(triangle_eval + 3) * (del_rkj[0] / rjk);
-            fkj[0] = -fjk[0];
-
-            fij[1] = *(triangle_eval + 1) * (del_rji[1] / rij);
-            fji[1] = -fij[1];
-            fik[1] = *(triangle_eval + 2) * (del_rki[1] / rik);
-            fki[1] = -fik[1];
-            fjk[1] = *(triangle_eval + 3) * (del_rkj[1] / rjk);
-            fkj[1] = -fjk[1];
-
-            fij[2] = *(triangle_eval + 1) * (del_rji[2] / rij);
-            fji[2] = -fij[2];
-            fik[2] = *(triangle_eval + 2) * (del_rki[2] / rik);
-            fki[2] = -fik[2];
-            fjk[2] = *(triangle_eval + 3) * (del_rkj[2] / rjk);
-            fkj[2] = -fjk[2];
-
-            Fi[0] = fij[0] + fik[0];
-            Fi[1] = fij[1] + fik[1];
-            Fi[2] = fij[2] + fik[2];
-            f[i][0] += Fi[0];
-            f[i][1] += Fi[1];
-            f[i][2] += Fi[2];
-
-            Fj[0] = fji[0] + fjk[0];
-            Fj[1] = fji[1] + fjk[1];
-            Fj[2] = fji[2] + fjk[2];
-            f[j][0] += Fj[0];
-            f[j][1] += Fj[1];
-            f[j][2] += Fj[2];
-
-            Fk[0] = fki[0] + fkj[0];
-            Fk[1] = fki[1] + fkj[1];
-            Fk[2] = fki[2] + fkj[2];
-            f[k][0] += Fk[0];
-            f[k][1] += Fk[1];
-            f[k][2] += Fk[2];
-
-            if (eflag) evdwl = *triangle_eval;
-
-            if (evflag) { ev_tally3(i, j, k, evdwl, 0, Fj, Fk, del_rji, del_rki);
-              // Centroid stress 3-body term
-              if (vflag_either && cvflag_atom) {
-                double ric[3];
-                ric[0] = THIRD * (-del_rji[0] - del_rki[0]);
-                ric[1] = THIRD * (-del_rji[1] - del_rki[1]);
-                ric[2] = THIRD * (-del_rji[2] - del_rki[2]);
-
-                cvatom[i][0] += ric[0] * Fi[0];
-                cvatom[i][1] += ric[1] * Fi[1];
-                cvatom[i][2] += ric[2] * Fi[2];
-                cvatom[i][3] += ric[0] * Fi[1];
-                cvatom[i][4] += ric[0] * Fi[2];
-                cvatom[i][5] += ric[1] * Fi[2];
-                cvatom[i][6] += ric[1] * Fi[0];
-                cvatom[i][7] += ric[2] * Fi[0];
-                cvatom[i][8] += ric[2] * Fi[1];
-
-                double rjc[3];
-                rjc[0] = THIRD * (del_rji[0] - del_rkj[0]);
-                rjc[1] = THIRD * (del_rji[1] - del_rkj[1]);
-                rjc[2] = THIRD * (del_rji[2] - del_rkj[2]);
-
-                cvatom[j][0] += rjc[0] * Fj[0];
-                cvatom[j][1] += rjc[1] * Fj[1];
-                cvatom[j][2] += rjc[2] * Fj[2];
-                cvatom[j][3] += rjc[0] * Fj[1];
-                cvatom[j][4] += rjc[0] * Fj[2];
-                cvatom[j][5] += rjc[1] * Fj[2];
-                cvatom[j][6] += rjc[1] * Fj[0];
-                cvatom[j][7] += rjc[2] * Fj[0];
-                cvatom[j][8] += rjc[2] * Fj[1];
-
-                double rkc[3];
-                rkc[0] = THIRD * (del_rki[0] + del_rkj[0]);
-                rkc[1] = THIRD * (del_rki[1] + del_rkj[1]);
-                rkc[2] = THIRD * (del_rki[2] + del_rkj[2]);
-
-                cvatom[k][0] += rkc[0] * Fk[0];
-                cvatom[k][1] += rkc[1] * Fk[1];
-                cvatom[k][2] += rkc[2] * Fk[2];
-                cvatom[k][3] += rkc[0] * Fk[1];
-                cvatom[k][4] += rkc[0] * Fk[2];
-                cvatom[k][5] += rkc[1] * Fk[2];
-                cvatom[k][6] += rkc[1] * Fk[0];
-                cvatom[k][7] += rkc[2] * Fk[0];
-                cvatom[k][8] += rkc[2] * Fk[1];
+      rij = rshort[jj];
+      del_rji = delshort[jj];
+
+      // kth atoms, one ktype group at a time. the groups of the types
+      // before jtype only hold neighbors that come before j
+      for (ktype = jtype; ktype < num_of_elements + 1; ktype++) {
+        const int id = id_3b(itype, jtype, ktype);
+        const uf3_interaction_3b &inter = interactions_3b[id];
+        if ((rij > inter.cut[2]) || (rij < inter.min_cut[2])) continue;
+
+        // the interaction is fixed over the group
+        uf3_triplet_bspline &bspline_3b = bsplines_3b[id];
+        const double cut_ik = inter.cut[1];
+        const double min_ik = inter.min_cut[1];
+        const double min_jk = inter.min_cut[0];
+        const double cut_jk = inter.cut[0];
+        uf3_axis_bases bases_ij;
+        bspline_3b.bases_ij(rij, bases_ij);
+
+        // the group is sorted, so no k past kend is within the ik cutoff
+        const int kbegin = (ktype == jtype) ? jj + 1 : short_start[ktype];
+        int kend = short_start[ktype + 1];
+        while ((kend > kbegin) && (rshort[kend - 1] > cut_ik)) kend--;
+
+        // nor is any k with |rik - rij| > cut_jk within the jk cutoff
+        int kfirst = kbegin, klast = kend;
+        while ((kfirst < klast) && (rshort[kfirst] < rij - cut_jk)) kfirst++;
+        while ((klast > kfirst) && (rshort[klast - 1] > rij + cut_jk)) klast--;
+
+        // kend only depends on jtype, so the first j of a jtype sets up the
+        // ik axes of the group for all following ones
+        if (ikshort_jtype[ktype] != jtype) {
+          for (kk = short_start[ktype]; kk < kend; kk++)
+            bspline_3b.bases_ik(rshort[kk], ikshort[kk]);
+          ikshort_jtype[ktype] = jtype;
+        }
+
+        // the ij contraction of the previous j is stale
+        slab_state_3b[ktype] = 0;
+
+        for (kk = kfirst; kk < klast; kk++) {
+
+          fik[0] = fki[0] = 0;
+          fik[1] = fki[1] = 0;
+          fik[2] = fki[2] = 0;
+
+          fjk[0] = fkj[0] = 0;
+          fjk[1] = fkj[1] = 0;
+          fjk[2] = fkj[2] = 0;
+
+          k = neighshort[kk];
+          rik = rshort[kk];
+
+          if (rik >= min_ik) {
+
+            del_rki = delshort[kk];
+
+            del_rkj[0] = del_rki[0] - del_rji[0];
+            del_rkj[1] = del_rki[1] - del_rji[1];
+            del_rkj[2] = del_rki[2] - del_rji[2];
+            rjk = sqrt(((del_rkj[0] * del_rkj[0]) + (del_rkj[1] * del_rkj[1]) +
+                        (del_rkj[2] * del_rkj[2])));
+
+            if ((rjk >= min_jk) && (rjk <= cut_jk)) {
+              double triangle_eval[4];
+              bspline_3b.eval_factorized(bases_ij, ikshort[kk], rjk, klast - kk, slab_3b[ktype],
+                                         slab_state_3b[ktype], triangle_eval);
+
+              fij[0] = *(triangle_eval + 1) * ushort[jj][0];
+              fji[0] = -fij[0];
+              fik[0] = *(triangle_eval + 2) * ushort[kk][0];
+              fki[0] = -fik[0];
+              fjk[0] = *(triangle_eval + 3) * (del_rkj[0] / rjk);
+              fkj[0] = -fjk[0];
+
+              fij[1] = *(triangle_eval + 1) * ushort[jj][1];
+              fji[1] = -fij[1];
+              fik[1] = *(triangle_eval + 2) * ushort[kk][1];
+              fki[1] = -fik[1];
+              fjk[1] = *(triangle_eval + 3) * (del_rkj[1] / rjk);
+              fkj[1] = -fjk[1];
+
+              fij[2] = *(triangle_eval + 1) * ushort[jj][2];
+              fji[2] = -fij[2];
+              fik[2] = *(triangle_eval + 2) * ushort[kk][2];
+              fki[2] = -fik[2];
+              fjk[2] = *(triangle_eval + 3) * (del_rkj[2] / rjk);
+              fkj[2] = -fjk[2];
+
+              Fi[0] = fij[0] + fik[0];
+              Fi[1] = fij[1] + fik[1];
+              Fi[2] = fij[2] + fik[2];
+              f[i][0] += Fi[0];
+              f[i][1] += Fi[1];
+              f[i][2] += Fi[2];
+
+              Fj[0] = fji[0] + fjk[0];
+              Fj[1] = fji[1] + fjk[1];
+              Fj[2] = fji[2] + fjk[2];
+              f[j][0] += Fj[0];
+              f[j][1] += Fj[1];
+              f[j][2] += Fj[2];
+
+              Fk[0] = fki[0] + fkj[0];
+              Fk[1] = fki[1] + fkj[1];
+              Fk[2] = fki[2] + fkj[2];
+              f[k][0] += Fk[0];
+              f[k][1] += Fk[1];
+              f[k][2] += Fk[2];
+
+              if (eflag) evdwl = *triangle_eval;
+
+              if (evflag) { ev_tally3(i, j, k, evdwl, 0, Fj, Fk, del_rji, del_rki);
+                // Centroid stress 3-body term
+                if (vflag_either && cvflag_atom) {
+                  double ric[3];
+                  ric[0] = THIRD * (-del_rji[0] - del_rki[0]);
+                  ric[1] = THIRD * (-del_rji[1] - del_rki[1]);
+                  ric[2] = THIRD * (-del_rji[2] - del_rki[2]);
+
+                  cvatom[i][0] += ric[0] * Fi[0];
+                  cvatom[i][1] += ric[1] * Fi[1];
+                  cvatom[i][2] += ric[2] * Fi[2];
+                  cvatom[i][3] += ric[0] * Fi[1];
+                  cvatom[i][4] += ric[0] * Fi[2];
+                  cvatom[i][5] += ric[1] * Fi[2];
+                  cvatom[i][6] += ric[1] * Fi[0];
+                  cvatom[i][7] += ric[2] * Fi[0];
+                  cvatom[i][8] += ric[2] * Fi[1];
+
+                  double rjc[3];
+                  rjc[0] = THIRD * (del_rji[0] - del_rkj[0]);
+                  rjc[1] = THIRD * (del_rji[1] - del_rkj[1]);
+                  rjc[2] = THIRD * (del_rji[2] - del_rkj[2]);
+
+                  cvatom[j][0] += rjc[0] * Fj[0];
+                  cvatom[j][1] += rjc[1] * Fj[1];
+                  cvatom[j][2] += rjc[2] * Fj[2];
+                  cvatom[j][3] += rjc[0] * Fj[1];
+                  cvatom[j][4] += rjc[0] * Fj[2];
+                  cvatom[j][5] += rjc[1] * Fj[2];
+                  cvatom[j][6] += rjc[1] * Fj[0];
+                  cvatom[j][7] += rjc[2] * Fj[0];
+                  cvatom[j][8] += rjc[2] * Fj[1];
+
+                  double rkc[3];
+                  rkc[0] = THIRD * (del_rki[0] + del_rkj[0]);
+                  rkc[1] = THIRD * (del_rki[1] + del_rkj[1]);
+                  rkc[2] = THIRD * (del_rki[2] + del_rkj[2]);
+
+                  cvatom[k][0] += rkc[0] * Fk[0];
+                  cvatom[k][1] += rkc[1] * Fk[1];
+                  cvatom[k][2] += rkc[2] * Fk[2];
+                  cvatom[k][3] += rkc[0] * Fk[1];
+                  cvatom[k][4] += rkc[0] * Fk[2];
+                  cvatom[k][5] += rkc[1] * Fk[2];
+                  cvatom[k][6] += rkc[1] * Fk[0];
+                  cvatom[k][7] += rkc[2] * Fk[0];
+                  cvatom[k][8] += rkc[2] * Fk[1];
+                }
               }
             }
           }
@@ -1232,9 +1317,10 @@ double PairUF3::single(int /*i*/, int /*j*/, int itype, int jtype, double rsq,
   double r = sqrt(rsq);
 
   if (r < cut[itype][jtype]) {
-    double *pair_eval = UFBS2b[itype][jtype].eval(r);
-    value = pair_eval[0];
-    fforce = factor_lj * pair_eval[1];
+    double e, dedr;
+    UFBS2b[itype][jtype]->eval_batch(&r, 1, &e, &dedr);
+    value = e;
+    fforce = factor_lj * dedr;
   }
 
   return factor_lj * value;
@@ -1250,62 +1336,43 @@ double PairUF3::memory_usage()
                                         //n2body_pot_files, n3body_pot_files, 
                                         //tot_pot_files;
 
-  bytes += (double)5*sizeof(double);    //bsplines_created, coeff_matrix_dim1,
-                                        //coeff_matrix_dim2, coeff_matrix_dim3, 
-                                        //coeff_matrix_elements_len
-  bytes += (double)(num_of_elements+1)*(num_of_elements+1)*\
-           (num_of_elements+1)*sizeof(double);      //***setflag_3b
-
+  bytes += (double)3*sizeof(int);       //bsplines_created, keep_pot_data, build_3b_splines
   bytes += (double)(num_of_elements+1)*(num_of_elements+1)*sizeof(double); //cut 
 
-  bytes += (double)(num_of_elements+1)*(num_of_elements+1)*\
-           (num_of_elements+1)*sizeof(double);      //***cut_3b
-
   bytes += (double)(num_of_elements+1)*(num_of_elements+1)*sizeof(double); //cut_3b_list
 
-  bytes += (double)(num_of_elements+1)*(num_of_elements+1)*\
-           (num_of_elements+1)*3*sizeof(double);    //min_cut_3b
-
-  for (int i=1; i < num_of_elements+1; i++){
-    for (int j=i; j < num_of_elements+1; j++){
-      bytes += (double)2*n2b_knot[i][j].size()*sizeof(double);      //n2b_knot
-      bytes += (double)2*n2b_coeff[i][j].size()*sizeof(double);     //n2b_coeff
-    }
-    if (pot_3b){
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        for (int k = j; k < num_of_elements + 1; k++) {
-          bytes += (double)2*n3b_knot_matrix[i][j][k][0].size()*sizeof(double);
-          bytes += (double)2*n3b_knot_matrix[i][j][k][1].size()*sizeof(double);
-          bytes += (double)2*n3b_knot_matrix[i][j][k][2].size()*sizeof(double);
-
-          std::string key = std::to_string(i) + std::to_string(j) + std::to_string(k);
-
-          for (int l=0; l < n3b_coeff_matrix[key].size(); l++){
-            for (int m=0; m < n3b_coeff_matrix[key][l].size(); m++){
-              bytes += (double)2*n3b_coeff_matrix[key][l][m].size()*sizeof(double);
-              //key = ijk
-              //key = ikj
-            }
-          }
-        }
-      }
-    }
-  }
-
-  for (int i = 1; i < num_of_elements + 1; i++) {
-    for (int j = i; j < num_of_elements + 1; j++){
-        bytes += (double)2*UFBS2b[i][j].memory_usage(); //UFBS2b[i][j] UFBS2b[j][1]
-    }
-    if (pot_3b) {
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        for (int k = j; k < num_of_elements + 1; k++) {
-          bytes += (double)2*UFBS3b[i][j][k].memory_usage();
-        }
-      }
-    }
-  }
+  bytes += (double)index_3b.size()*sizeof(int);                           //index_3b
+  bytes += (double)interactions_3b.size()*sizeof(uf3_interaction_3b);     //interactions_3b
+
+  // potential data until it is released, every file once
+  std::unordered_map<const uf3_pot_data *, int> counted;
+  auto count_pot = [&](const uf3_pot_ref &ref) {
+    if (!ref.pot || counted[ref.pot.get()]++) return;
+    for (int a = 0; a < 3; a++) bytes += (double)ref.pot->knots[a].size()*sizeof(double);
+    bytes += (double)ref.pot->coeff.size()*sizeof(double);
+  };
+  for (auto &row : pot_data_2b)
+    for (auto &ref : row) count_pot(ref);
+  for (auto &inter : interactions_3b) count_pot(inter.pot);
+
+  for (int k = 0; k < (int)bsplines_2b.size(); k++)
+    bytes += (double)bsplines_2b[k].memory_usage();     //UFBS2b[i][j] == UFBS2b[j][i]
+  for (int k = 0; k < (int)bsplines_3b.size(); k++)
+    bytes += (double)bsplines_3b[k].memory_usage();     //i-j-k and i-k-j share one
   
   bytes += (double)(maxshort+1)*sizeof(int);            //neighshort, maxshort
+  bytes += (double)maxshort*sizeof(double);              //rshort
+  bytes += (double)6*maxshort*sizeof(double);            //delshort, ushort
+  bytes += (double)maxshort*sizeof(uf3_axis_bases);      //ikshort
+  bytes += (double)ikshort_jtype.size()*sizeof(int);     //ikshort_jtype
+  bytes += (double)maxpshort*sizeof(int);                //pshort
+  bytes += (double)2*maxpshort_ii*sizeof(int);           //pshort_start, pshort_num
+  bytes += (double)rcand_3b.capacity()*sizeof(double);   //rcand_3b
+
+  for (int k = 0; k < (int)slab_3b.size(); k++)
+    bytes += (double)slab_3b[k].d.capacity()*sizeof(double) +
+             (double)slab_3b[k].f.capacity()*sizeof(float);   //slab_3b
+  bytes += (double)slab_state_3b.size()*sizeof(int);        //slab_state_3b
 
   return bytes;
 }
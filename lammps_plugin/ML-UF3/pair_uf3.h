@@ -31,6 +31,7 @@ PairStyle(uf3,PairUF3);
 
 #include "pair.h"
 
+#include <memory>
 #include <unordered_map>
 namespace LAMMPS_NS {
 
@@ -42,30 +43,98 @@ class PairUF3 : public Pair {
   void settings(int, char **) override;
   void coeff(int, char **) override;
   void init_style() override;
-  void init_list(int, class NeighList *) override;    // needed for ptr to full neigh list
+  void init_list(int, class NeighList *) override;    // needed for ptrs to the two neigh lists
   double init_one(int, int) override;                 // needed for cutoff radius for neighbour list
   double single(int, int, int, int, double, double, double, double &) override;
 
   double memory_usage() override;
 
  protected:
-  void uf3_read_pot_file(char *potf_name);
   void uf3_read_pot_file(int i, int j, char *potf_name);
   void uf3_read_pot_file(int i, int j, int k, char *potf_name);
+  void uf3_no_3b(int i, int j, int k);
   int num_of_elements, nbody_flag, n2body_pot_files, n3body_pot_files, tot_pot_files;
   int bsplines_created;
-  int coeff_matrix_dim1, coeff_matrix_dim2, coeff_matrix_dim3, coeff_matrix_elements_len;
+  int layout_3b;    // memory layout of the 3-body coefficient tensors
+  int precision_3b;    // floating point precision of the 3-body contractions
+  int storage_3b;      // storage format of the 3-body coefficient tensors
   bool pot_3b;
-  int ***setflag_3b, **knot_spacing_type_2b, ***knot_spacing_type_3b;
-  double **cut, ***cut_3b, **cut_3b_list, ****min_cut_3b;
+  int **knot_spacing_type_2b;
+  double **cut, **cut_3b_list;
   virtual void allocate();
   void create_bsplines();
-  std::vector<std::vector<std::vector<double>>> n2b_knot, n2b_coeff;
-  std::vector<std::vector<std::vector<std::vector<std::vector<double>>>>> n3b_knot_matrix;
-  std::unordered_map<std::string, std::vector<std::vector<std::vector<double>>>> n3b_coeff_matrix;
-  std::vector<std::vector<uf3_pair_bspline>> UFBS2b;
-  std::vector<std::vector<std::vector<uf3_triplet_bspline>>> UFBS3b;
+  // content of one potential file, 3-body axes in the order of the file
+  struct uf3_pot_data {
+    int nbody = 0, knot_spacing = 0;
+    double cut[3] = {0.0, 0.0, 0.0};    // 2B: rij, 3B: rjk rik rij
+    int shape[3] = {0, 0, 0};           // 2B: coefficients, 3B: [ij][ik][jk] tensor
+    std::vector<double> knots[3];       // 2B: knots[0], 3B: jk ik ij
+    std::vector<double> coeff;          // 3B: flat, jk contiguous
+  };
+  // the potential files are the only copy of the parsed data. every
+  // interaction set from a file shares it, [i][j] and [j][i] of a 2-body
+  // file as well as [i][j][k] and [i][k][j] of a 3-body file, where the
+  // one that is not in the order of the file has the ik and ij axes swapped.
+  // they are released once the splines are built, see release_pot_data()
+  struct uf3_pot_ref {
+    std::shared_ptr<const uf3_pot_data> pot;
+    int swapped = 0;
+  };
+  std::vector<std::vector<uf3_pot_ref>> pot_data_2b;
+  std::unordered_map<std::string, std::shared_ptr<const uf3_pot_data>> pot_cache;    // by file name
+  int keep_pot_data;    // 1 if a derived style reads the potential data after create_bsplines()
+  int build_3b_splines;    // 0 if a derived style evaluates the 3-body term from its own tables
+  std::shared_ptr<const uf3_pot_data> read_pot_data(const std::string &);
+  void bcast_pot_data(uf3_pot_data &);
+  void read_pot_text(const std::string &, uf3_pot_data &);
+  void read_pot_binary(const std::string &, uf3_pot_data &);
+  void release_pot_data();
+  // 3-body interactions, one per itype and unordered jtype-ktype, stored in
+  // the order i-j-k with jtype <= ktype. i-k-j is the same interaction
+  // with the ik and ij axes swapped. an interaction declared with none, or
+  // not set, has zero cutoffs, so every triplet of it is skipped
+  struct uf3_interaction_3b {
+    int set = 0;             // 1 from a potential file, -1 declared without 3-body term
+    int knot_spacing = 0;    // 0 uniform, 1 non-uniform
+    int tricubic = 0;        // 1 if the spline is stored as per cell tricubics
+    double cut[3] = {0.0, 0.0, 0.0};        // jk ik ij cutoffs
+    double min_cut[3] = {0.0, 0.0, 0.0};    // jk ik ij first knots
+    uf3_pot_ref pot;
+  };
+  std::vector<uf3_interaction_3b> interactions_3b;
+  std::vector<int> index_3b;    // interaction of the ordered triplet, see id_3b()
+  int id_3b(int i, int j, int k) const
+  {
+    return index_3b[(i * (num_of_elements + 1) + j) * (num_of_elements + 1) + k];
+  }
+  void set_cut_3b_list(int i);
+  // the potential data of an interaction, 3-body knots a = 0, 1, 2 along jk, ik, ij
+  const std::vector<double> &knots_2b(int i, int j) const { return pot_data_2b[i][j].pot->knots[0]; }
+  const std::vector<double> &coeff_2b(int i, int j) const { return pot_data_2b[i][j].pot->coeff; }
+  const std::vector<double> &knots_3b(int id, int a) const;
+  uf3_tensor_view coeff_3b(int id) const;
+  // symmetric type pairs share one spline, UFBS2b[i][j] == UFBS2b[j][i]
+  std::vector<uf3_pair_bspline> bsplines_2b;
+  std::vector<std::vector<uf3_pair_bspline *>> UFBS2b;
+  // the 3-body spline of every interaction, empty if it has no 3-body term
+  std::vector<uf3_triplet_bspline> bsplines_3b;
+  class NeighList *list_3b;     // full list at the 3-body cutoffs, list is the 2-body half list
   int *neighshort, maxshort;    // short neighbor list array for 3body interaction
+  double *rshort;               // distances of neighshort, ascending per type
+  double **delshort, **ushort;    // displacements of neighshort from i and their unit vectors
+  uf3_axis_bases *ikshort;        // ik axes of neighshort for the current jtype
+  std::vector<int> ikshort_jtype;    // per ktype the jtype the ikshort group was set up for
+  std::vector<int> short_start;    // start of the ktype group in neighshort
+  std::vector<uf3_slab> slab_3b;               // per ktype 3-body tensor contracted along ij
+  std::vector<int> slab_state_3b;              // per ktype state of slab_3b for the current j
+
+  // 3-body candidates kept between neighbor list builds, see setup_candidates_3b()
+  int persist_3b;                              // 1 if enabled by the persist keyword
+  int *pshort, *pshort_start, *pshort_num;     // candidates of ilist[ii] in the 3-body list
+  int maxpshort, maxpshort_ii, pshort_ready;
+  std::vector<double> rcand_3b;                // scratch of collect_candidates_3b()
+  void setup_candidates_3b();
+  int collect_candidates_3b(int, const int *, int, int *, std::vector<double> &);
 };
 
 }    // namespace LAMMPS_NS
@@ -0,0 +1,58 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/ Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Allocator for std::vector that places the data on 64-byte (cache line)
+// boundaries, so flat spline tensors keep value semantics while their
+// rows line up with cache lines
+//
+
+#include <cstddef>
+#include <new>
+
+#ifndef UF3_ALIGNED_ALLOCATOR_H
+#define UF3_ALIGNED_ALLOCATOR_H
+
+namespace LAMMPS_NS {
+
+template <class T> struct uf3_aligned_allocator {
+  typedef T value_type;
+  static constexpr std::size_t alignment = 64;
+
+  uf3_aligned_allocator() noexcept {}
+  template <class U> uf3_aligned_allocator(const uf3_aligned_allocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n)
+  {
+    return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+  }
+  void deallocate(T *p, std::size_t) noexcept
+  {
+    ::operator delete(p, std::align_val_t(alignment));
+  }
+
+  template <class U> struct rebind {
+    typedef uf3_aligned_allocator<U> other;
+  };
+};
+
+template <class T, class U>
+bool operator==(const uf3_aligned_allocator<T> &, const uf3_aligned_allocator<U> &)
+{
+  return true;
+}
+template <class T, class U>
+bool operator!=(const uf3_aligned_allocator<T> &, const uf3_aligned_allocator<U> &)
+{
+  return false;
+}
+
+}    // namespace LAMMPS_NS
+#endif
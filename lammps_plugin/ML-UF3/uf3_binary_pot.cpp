@@ -0,0 +1,115 @@
+#include "uf3_binary_pot.h"
+
+#include "error.h"
+
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace LAMMPS_NS;
+
+static const char uf3_binary_magic[8] = {'U', 'F', '3', 'B', 'P', 'O', 'T', '\0'};
+
+bool uf3_binary_pot::is_binary(const std::string &path)
+{
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) return false;
+  char magic[8];
+  const bool found = (fread(magic, 1, 8, fp) == 8) && (memcmp(magic, uf3_binary_magic, 8) == 0);
+  fclose(fp);
+  return found;
+}
+
+uf3_binary_pot::uf3_binary_pot(LAMMPS *ulmp, const std::string &upath) :
+    lmp(ulmp), path(upath), base(nullptr), size(0), mapped(0), hdr(nullptr)
+{
+  const uint16_t one = 1;
+  if (*reinterpret_cast<const char *>(&one) != 1)
+    lmp->error->one(FLERR, "UF3: Binary potential files need a little endian host");
+
+#if !defined(_WIN32)
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) lmp->error->one(FLERR, "UF3: Cannot open binary potential file {}", path);
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    lmp->error->one(FLERR, "UF3: Cannot stat binary potential file {}", path);
+  }
+  size = st.st_size;
+  if (size >= sizeof(uf3_binary_header)) {
+    void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED) {
+      base = static_cast<const char *>(p);
+      mapped = 1;
+    }
+  }
+  close(fd);
+#endif
+
+  // no mmap, read the file into memory instead
+  if (!base) {
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (!fp) lmp->error->one(FLERR, "UF3: Cannot open binary potential file {}", path);
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    // allocated as doubles so the blocks are aligned
+    double *buf = new double[size / sizeof(double) + 1];
+    const size_t nread = fread(buf, 1, size, fp);
+    fclose(fp);
+    base = reinterpret_cast<const char *>(buf);
+    if (nread != size)
+      lmp->error->one(FLERR, "UF3: Error reading binary potential file {}", path);
+  }
+
+  if (size < sizeof(uf3_binary_header))
+    lmp->error->one(FLERR, "UF3: Binary potential file {} is truncated", path);
+  hdr = reinterpret_cast<const uf3_binary_header *>(base);
+
+  if (memcmp(hdr->magic, uf3_binary_magic, 8) != 0)
+    lmp->error->one(FLERR, "UF3: {} is not a binary UF3 potential file", path);
+  if (hdr->version != UF3_BINARY_VERSION)
+    lmp->error->one(FLERR, "UF3: {} has binary format version {}, supported is version {}", path,
+                    hdr->version, UF3_BINARY_VERSION);
+  if (hdr->file_size != size)
+    lmp->error->one(FLERR, "UF3: Binary potential file {} has {} bytes, expected {}", path, size,
+                    hdr->file_size);
+  if ((hdr->nbody != 2) && (hdr->nbody != 3))
+    lmp->error->one(FLERR, "UF3: {} holds a {}-body potential, expected 2 or 3", path,
+                    hdr->nbody);
+
+  const int naxes = (hdr->nbody == 2) ? 1 : 3;
+  uint64_t ncoeff = 1;
+  for (int a = 0; a < naxes; a++) {
+    check_block(hdr->knots_offset[a], hdr->nknots[a], "knots");
+    if (hdr->shape[a] > (1u << 20))
+      lmp->error->one(FLERR, "UF3: {} has {} coefficients along an axis", path, hdr->shape[a]);
+    ncoeff *= hdr->shape[a];
+  }
+  check_block(hdr->coeff_offset, ncoeff, "coefficients");
+}
+
+uf3_binary_pot::~uf3_binary_pot()
+{
+#if !defined(_WIN32)
+  if (mapped) {
+    munmap(const_cast<char *>(base), size);
+    return;
+  }
+#endif
+  delete[] reinterpret_cast<const double *>(base);
+}
+
+// [count] doubles at [offset] must be aligned and inside the file
+void uf3_binary_pot::check_block(uint64_t offset, uint64_t count, const char *what)
+{
+  if ((offset < sizeof(uf3_binary_header)) || (offset % sizeof(double) != 0) || (offset > size) ||
+      (count > (size - offset) / sizeof(double)))
+    lmp->error->one(FLERR, "UF3: Binary potential file {} has invalid {} block", path, what);
+}
@@ -0,0 +1,85 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/ Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Binary UF3 potential files. They hold the same data as one '#UF3 POT'
+// text file: a fixed size header followed by the knot vectors and the
+// coefficients as little endian doubles, each block starting at a 64 byte
+// aligned offset listed in the header. The file is mapped read-only by
+// the rank that reads it and the knots and coefficients are taken from
+// the mapping without parsing, the 3-body coefficients are stored
+// [ij][ik][jk] with jk contiguous as in the text files. Errors are
+// reported with Error::one().
+// scripts/uf3_pot_binary.py converts text files to this format.
+//
+
+#include "pointers.h"
+
+#include <cstdint>
+#include <string>
+
+#ifndef UF3_BINARY_POT_H
+#define UF3_BINARY_POT_H
+
+namespace LAMMPS_NS {
+
+struct uf3_binary_header {
+  char magic[8];                 // "UF3BPOT" followed by a zero byte
+  uint32_t version;              // format version, see UF3_BINARY_VERSION
+  uint32_t nbody;                // 2 or 3
+  uint32_t leading_trim, trailing_trim;
+  uint32_t knot_spacing;         // 0 uniform, 1 non-uniform
+  uint32_t reserved;
+  double cut[3];                 // 2B: rij, 3B: rjk rik rij as in the text files
+  uint64_t nknots[3];            // 2B: knots, 3B: jk ik ij knots
+  uint64_t shape[3];             // 2B: coefficients, 3B: shape of the [ij][ik][jk] tensor
+  uint64_t knots_offset[3];      // byte offsets of the knot vectors
+  uint64_t coeff_offset;         // byte offset of the coefficients
+  uint64_t file_size;
+};
+
+static_assert(sizeof(uf3_binary_header) == 144, "UF3: unexpected binary header size");
+
+class uf3_binary_pot {
+ public:
+  static constexpr uint32_t UF3_BINARY_VERSION = 1;
+
+  // map [path] and check the header and the block bounds
+  uf3_binary_pot(LAMMPS *ulmp, const std::string &path);
+  ~uf3_binary_pot();
+
+  uf3_binary_pot(const uf3_binary_pot &) = delete;
+  uf3_binary_pot &operator=(const uf3_binary_pot &) = delete;
+
+  // true if [path] starts with the binary magic
+  static bool is_binary(const std::string &path);
+
+  const uf3_binary_header &header() const { return *hdr; }
+  int nbody() const { return hdr->nbody; }
+  const double *knots(int axis) const { return at(hdr->knots_offset[axis]); }
+  const double *coeff() const { return at(hdr->coeff_offset); }
+
+ private:
+  LAMMPS *lmp;
+  std::string path;
+  const char *base;      // start of the mapped (or read) file
+  size_t size;
+  int mapped;            // 1 if base is an mmap, else it owns a heap copy
+  const uf3_binary_header *hdr;
+
+  const double *at(uint64_t offset) const
+  {
+    return reinterpret_cast<const double *>(base + offset);
+  }
+  void check_block(uint64_t offset, uint64_t count, const char *what);
+};
+
+}    // namespace LAMMPS_NS
+#endif
@@ -1,7 +1,7 @@
 #include "uf3_bspline_basis2.h"
 
 #include "utils.h"
-#include <vector>
+#include <cmath>
 
 using namespace LAMMPS_NS;
 
@@ -22,9 +22,9 @@ uf3_bspline_basis2::uf3_bspline_basis2(LAMMPS *ulmp, const double *knots, double
        (pow(knots[0], 2) - knots[0] * knots[1] - knots[0] * knots[2] + knots[1] * knots[2]));
   c2 = coefficient *
       (1 / (pow(knots[0], 2) - knots[0] * knots[1] - knots[0] * knots[2] + knots[1] * knots[2]));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
+  constants[0] = c0;
+  constants[1] = c1;
+  constants[2] = c2;
   c0 = coefficient *
       (-knots[1] * knots[3] /
            (pow(knots[1], 2) - knots[1] * knots[2] - knots[1] * knots[3] + knots[2] * knots[3]) -
@@ -42,9 +42,9 @@ uf3_bspline_basis2::uf3_bspline_basis2(LAMMPS *ulmp, const double *knots, double
   c2 = coefficient *
       (-1 / (pow(knots[1], 2) - knots[1] * knots[2] - knots[1] * knots[3] + knots[2] * knots[3]) -
        1 / (knots[0] * knots[1] - knots[0] * knots[2] - knots[1] * knots[2] + pow(knots[2], 2)));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
+  constants[3] = c0;
+  constants[4] = c1;
+  constants[5] = c2;
   c0 = coefficient *
       (pow(knots[3], 2) /
        (knots[1] * knots[2] - knots[1] * knots[3] - knots[2] * knots[3] + pow(knots[3], 2)));
@@ -53,9 +53,9 @@ uf3_bspline_basis2::uf3_bspline_basis2(LAMMPS *ulmp, const double *knots, double
        (knots[1] * knots[2] - knots[1] * knots[3] - knots[2] * knots[3] + pow(knots[3], 2)));
   c2 = coefficient *
       (1 / (knots[1] * knots[2] - knots[1] * knots[3] - knots[2] * knots[3] + pow(knots[3], 2)));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
+  constants[6] = c0;
+  constants[7] = c1;
+  constants[8] = c2;
 }
 
 uf3_bspline_basis2::~uf3_bspline_basis2() {}
@@ -82,7 +82,7 @@ double uf3_bspline_basis2::memory_usage()
 {
   double bytes = 0;
 
-  bytes += (double)constants.size()*sizeof(double);
+  bytes += (double)9*sizeof(double);          //constants
 
   return bytes;
 }
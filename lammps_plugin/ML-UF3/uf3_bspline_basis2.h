@@ -6,8 +6,6 @@
 //
 #include "pointers.h"
 
-#include <vector>
-
 #ifndef UF3_BSPLINE_BASIS2_H
 #define UF3_BSPLINE_BASIS2_H
 
@@ -16,7 +14,7 @@ namespace LAMMPS_NS {
 class uf3_bspline_basis2 {
  private:
   LAMMPS *lmp;
-  std::vector<double> constants;
+  double constants[9];    // c0..c2 of the 3 pieces
 
  public:
   uf3_bspline_basis2(LAMMPS *ulmp, const double *knots, double coefficient);
@@ -1,7 +1,7 @@
 #include "uf3_bspline_basis3.h"
 
 #include "utils.h"
-#include <vector>
+#include <cmath>
 
 using namespace LAMMPS_NS;
 
@@ -38,10 +38,10 @@ uf3_bspline_basis3::uf3_bspline_basis3(LAMMPS *ulmp, const double *knots, double
         pow(knots[0], 2) * knots[3] - knots[0] * knots[1] * knots[2] -
         knots[0] * knots[1] * knots[3] - knots[0] * knots[2] * knots[3] +
         knots[1] * knots[2] * knots[3]));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
-  constants.push_back(c3);
+  constants[0] = c0;
+  constants[1] = c1;
+  constants[2] = c2;
+  constants[3] = c3;
   c0 = coefficient *
       (pow(knots[1], 2) * knots[4] /
            (-pow(knots[1], 3) + pow(knots[1], 2) * knots[2] + pow(knots[1], 2) * knots[3] +
@@ -146,10 +146,10 @@ uf3_bspline_basis3::uf3_bspline_basis3(LAMMPS *ulmp, const double *knots, double
             knots[0] * knots[1] * knots[3] - knots[0] * knots[2] * knots[3] +
             pow(knots[1], 2) * knots[3] - knots[1] * knots[2] * knots[3] -
             knots[1] * pow(knots[3], 2) + knots[2] * pow(knots[3], 2)));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
-  constants.push_back(c3);
+  constants[4] = c0;
+  constants[5] = c1;
+  constants[6] = c2;
+  constants[7] = c3;
   c0 = coefficient *
       (-knots[0] * pow(knots[3], 2) /
            (-knots[0] * knots[1] * knots[2] + knots[0] * knots[1] * knots[3] +
@@ -254,10 +254,10 @@ uf3_bspline_basis3::uf3_bspline_basis3(LAMMPS *ulmp, const double *knots, double
             knots[1] * knots[2] * knots[4] - knots[1] * knots[3] * knots[4] +
             pow(knots[2], 2) * knots[4] - knots[2] * knots[3] * knots[4] -
             knots[2] * pow(knots[4], 2) + knots[3] * pow(knots[4], 2)));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
-  constants.push_back(c3);
+  constants[8] = c0;
+  constants[9] = c1;
+  constants[10] = c2;
+  constants[11] = c3;
   c0 = coefficient *
       (pow(knots[4], 3) /
        (-knots[1] * knots[2] * knots[3] + knots[1] * knots[2] * knots[4] +
@@ -282,10 +282,10 @@ uf3_bspline_basis3::uf3_bspline_basis3(LAMMPS *ulmp, const double *knots, double
         knots[1] * knots[3] * knots[4] - knots[1] * pow(knots[4], 2) +
         knots[2] * knots[3] * knots[4] - knots[2] * pow(knots[4], 2) - knots[3] * pow(knots[4], 2) +
         pow(knots[4], 3)));
-  constants.push_back(c0);
-  constants.push_back(c1);
-  constants.push_back(c2);
-  constants.push_back(c3);
+  constants[12] = c0;
+  constants[13] = c1;
+  constants[14] = c2;
+  constants[15] = c3;
 }
 
 uf3_bspline_basis3::~uf3_bspline_basis3() {}
@@ -314,11 +314,16 @@ double uf3_bspline_basis3::eval3(double rth, double rsq, double r)
   return rth * constants[15] + rsq * constants[14] + r * constants[13] + constants[12];
 }
 
+const double *uf3_bspline_basis3::get_constants() const
+{
+  return constants;
+}
+
 double uf3_bspline_basis3::memory_usage()
 {
   double bytes = 0;
 
-  bytes += (double)constants.size()*sizeof(double);
+  bytes += (double)16*sizeof(double);          //constants
 
   return bytes;
 }
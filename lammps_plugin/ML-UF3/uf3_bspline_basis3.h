@@ -6,8 +6,6 @@
 //
 #include "pointers.h"
 
-#include <vector>
-
 #ifndef UF3_BSPLINE_BASIS3_H
 #define UF3_BSPLINE_BASIS3_H
 
@@ -16,7 +14,7 @@ namespace LAMMPS_NS {
 class uf3_bspline_basis3 {
  private:
   LAMMPS *lmp;
-  std::vector<double> constants;
+  double constants[16];    // c0..c3 of the 4 pieces
 
  public:
   uf3_bspline_basis3(LAMMPS *ulmp, const double *knots, double coefficient);
@@ -25,6 +23,8 @@ class uf3_bspline_basis3 {
   double eval1(double, double, double);
   double eval2(double, double, double);
   double eval3(double, double, double);
+  // c0..c3 of the 4 pieces (16 values), the constants of piece n start at 4*n
+  const double *get_constants() const;
 
   double memory_usage();
 };
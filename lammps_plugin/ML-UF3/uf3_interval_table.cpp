@@ -0,0 +1,103 @@
+#include "uf3_interval_table.h"
+
+#include "uf3_bspline_basis3.h"
+
+#include "error.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+using namespace LAMMPS_NS;
+
+// Dummy constructor
+uf3_interval_table::uf3_interval_table() : nint(0), uniform(0), kstart(0), inv_spacing(0) {}
+
+// Tabulate the bases of [knots]. If [coeff] is not empty the bases are
+// scaled with it and their sum is tabulated in [spline] and its derivative
+// in [dspline]
+uf3_interval_table::uf3_interval_table(LAMMPS *ulmp, const std::vector<double> &knots,
+                                       int knot_spacing_type, const std::vector<double> &coeff)
+{
+  const int n = knots.size();
+  nint = n - 7;
+  if (nint < 1) ulmp->error->all(FLERR, "UF3: A spline needs at least 8 knots");
+
+  uniform = (knot_spacing_type == 0) ? 1 : 0;
+  kstart = knots[3];
+  inv_spacing = 1.0 / (knots[4] - knots[3]);
+  if (!uniform && !make_buckets(knots, kstart, inv_spacing, bucket)) inv_spacing = 0.0;
+
+  // the cubics are re-expanded around the start of the interval
+  for (int s = 3; s <= n - 5; s++) {
+    const double t = knots[s];
+    tlow.push_back(t);
+    tnext.push_back((s < n - 5) ? knots[s + 1] : DBL_MAX);
+    double sum[4] = {0, 0, 0, 0};
+    for (int m = 0; m < 4; m++) {
+      const int l = s - 3 + m;
+      uf3_bspline_basis3 bspline(ulmp, &knots[l], coeff.empty() ? 1.0 : coeff[l]);
+      const double *c = bspline.get_constants() + 4 * (3 - m);
+      const double shifted[4] = {c[0] + (c[1] + (c[2] + c[3] * t) * t) * t,
+                                 c[1] + (2 * c[2] + 3 * c[3] * t) * t, c[2] + 3 * c[3] * t, c[3]};
+      for (int p = 0; p < 4; p++) {
+        basis.push_back(shifted[p]);
+        sum[p] += shifted[p];
+      }
+    }
+    if (!coeff.empty()) {
+      for (int p = 0; p < 4; p++) spline.push_back(sum[p]);
+      for (int p = 1; p < 4; p++) dspline.push_back(p * sum[p]);
+    }
+  }
+}
+
+// Buckets of half the smallest interval width starting at the first
+// interval. Each holds the interval before the one containing its start, so
+// r in the bucket lies in that interval or one of the next two, which takes
+// two comparisons with tnext even if r is rounded into a neighbouring bucket
+int uf3_interval_table::make_buckets(const std::vector<double> &knots, double &bstart,
+                                     double &binv, std::vector<int> &bucket, int max_bucket)
+{
+  const int n = knots.size();
+  bucket.clear();
+  if (n < 8) return 0;
+
+  double width = knots[n - 4] - knots[3];
+  for (int s = 3; s <= n - 5; s++) width = std::min(width, knots[s + 1] - knots[s]);
+  if (!(width > 0.0)) return 0;
+
+  width *= 0.5;
+  const double nbucket = (knots[n - 4] - knots[3]) / width + 1;
+  if (nbucket > max_bucket) return 0;
+
+  bstart = knots[3];
+  binv = 1.0 / width;
+  for (int b = 0; b < static_cast<int>(nbucket); b++) {
+    const double t = bstart + b * width;
+    int idx = 0;
+    for (int s = 4; s <= n - 5; s++) idx += (t >= knots[s]) ? 1 : 0;
+    bucket.push_back((idx > 0) ? idx - 1 : 0);
+  }
+  return 1;
+}
+
+// Destructor
+uf3_interval_table::~uf3_interval_table() {}
+
+double uf3_interval_table::memory_usage()
+{
+  double bytes = 0;
+
+  bytes += (double)2*sizeof(int);                   //nint, uniform
+  bytes += (double)2*sizeof(double);                //kstart, inv_spacing
+  bytes += (double)bucket.size()*sizeof(int);      //bucket
+  bytes += (double)tlow.size()*sizeof(double);      //tlow
+  bytes += (double)tnext.size()*sizeof(double);     //tnext
+  bytes += (double)basis.size()*sizeof(double);     //basis
+  bytes += (double)basis_f.size()*sizeof(float);    //basis_f
+  bytes += (double)spline.size()*sizeof(double);    //spline
+  bytes += (double)dspline.size()*sizeof(double);   //dspline
+
+  return bytes;
+}
@@ -0,0 +1,132 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/ Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Cubic B-spline bases of one knot vector tabulated per knot interval.
+// On interval s = [knots[s], knots[s+1]) the 4 non-zero bases s-3..s are
+// stored as cubics in (r - knots[s]), their sum weighted with the spline
+// coefficients is stored as well, together with its derivative. The lookup
+// and evaluation are inline and branch free so they can be used inside
+// vectorized loops. Uniform knots are looked up directly, non-uniform knots
+// through a table of buckets narrower than the smallest knot interval.
+//
+
+#include "pointers.h"
+
+#include <vector>
+
+#ifndef UF3_INTERVAL_TABLE_H
+#define UF3_INTERVAL_TABLE_H
+
+namespace LAMMPS_NS {
+
+// position of a distance in a table and the bases that are non-zero there,
+// kept by callers that reuse the same distance for several evaluations
+struct uf3_axis_bases {
+  int idx;                // interval, also the index of the first non-zero basis
+  double u;               // offset from the start of the interval
+  double b[4], db[4];     // values and derivatives of the bases
+};
+
+class uf3_interval_table {
+ public:
+  uf3_interval_table();
+  uf3_interval_table(LAMMPS *ulmp, const std::vector<double> &knots, int knot_spacing_type,
+                     const std::vector<double> &coeff);
+  ~uf3_interval_table();
+
+  int nint;                      // number of non-empty knot intervals
+  int uniform;                   // 1 if the knots are uniformly spaced
+  double kstart, inv_spacing;    // start and 1/spacing of uniform knots, or of the buckets
+  std::vector<int> bucket;       // non-uniform knots: interval at the start of each bucket
+  std::vector<double> tlow;      // start of each interval
+  std::vector<double> tnext;     // start of the next interval, DBL_MAX for the last one
+  std::vector<double> basis;     // 4x4 per interval, basis m at 4*m
+  std::vector<float> basis_f;    // single precision copy of basis, see set_single()
+  std::vector<double> spline;    // 4 per interval, sum of the bases times coefficients
+  std::vector<double> dspline;   // 3 per interval, derivative of spline
+
+  // index of the interval containing r (0 .. nint-1), values outside the
+  // knots are assigned to the first/last interval. SPACING is the knot
+  // spacing type the table was built for (0 uniform, 1 non-uniform), so
+  // the callers pick the lookup once instead of per distance.
+  template <int SPACING> inline int interval(double r) const
+  {
+    int idx = static_cast<int>((r - kstart) * inv_spacing);
+    if (SPACING == 1) {
+      const int nbucket = bucket.size();
+      if (nbucket) {
+        idx = (idx < 0) ? 0 : idx;
+        idx = bucket[(idx > nbucket - 1) ? nbucket - 1 : idx];
+        idx += (r >= tnext[idx]) ? 1 : 0;
+        idx += (r >= tnext[idx]) ? 1 : 0;
+      } else {
+        idx = 0;
+        for (int m = 1; m < nint; m++) idx += (r >= tlow[m]) ? 1 : 0;
+      }
+    }
+    idx = (idx < 0) ? 0 : idx;
+    return (idx > nint - 1) ? nint - 1 : idx;
+  }
+
+  // spline value and derivative at r
+  template <int SPACING> inline void eval(double r, double &e, double &dedr) const
+  {
+    const int idx = interval<SPACING>(r);
+    const double u = r - tlow[idx];
+    const double *c = &spline[4 * idx];
+    const double *dc = &dspline[3 * idx];
+    e = ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+    dedr = (dc[2] * u + dc[1]) * u + dc[0];
+  }
+
+  // values and derivatives of the 4 bases that are non-zero at r,
+  // returns the index of the first one. with T = float they are evaluated
+  // in single precision from basis_f, the interval is found in double.
+  template <int SPACING, typename T> inline int eval_bases(double r, T *b, T *db) const
+  {
+    const int idx = interval<SPACING>(r);
+    const T u = r - tlow[idx];
+    const T *c = basis_data(T()) + 16 * idx;
+    for (int m = 0; m < 4; m++) {
+      b[m] = ((c[4 * m + 3] * u + c[4 * m + 2]) * u + c[4 * m + 1]) * u + c[4 * m];
+      db[m] = (3 * c[4 * m + 3] * u + 2 * c[4 * m + 2]) * u + c[4 * m + 1];
+    }
+    return idx;
+  }
+
+  // interval and offset of r only
+  template <int SPACING> inline void locate(double r, uf3_axis_bases &ab) const
+  {
+    ab.idx = interval<SPACING>(r);
+    ab.u = r - tlow[ab.idx];
+  }
+
+  // interval, offset and bases at r
+  template <int SPACING> inline void eval_bases(double r, uf3_axis_bases &ab) const
+  {
+    ab.idx = eval_bases<SPACING>(r, ab.b, ab.db);
+    ab.u = r - tlow[ab.idx];
+  }
+
+  void set_single() { basis_f.assign(basis.begin(), basis.end()); }
+  const double *basis_data(double) const { return basis.data(); }
+  const float *basis_data(float) const { return basis_f.data(); }
+
+  // bucket table of the interval lookup for non-uniform [knots], returns 0
+  // if the knots need more than [max_bucket] buckets or have empty intervals
+  static int make_buckets(const std::vector<double> &knots, double &bstart, double &binv,
+                          std::vector<int> &bucket, int max_bucket = 65536);
+
+  double memory_usage();
+};
+
+}    // namespace LAMMPS_NS
+#endif
@@ -1,7 +1,6 @@
 #include "uf3_pair_bspline.h"
 
-#include "uf3_bspline_basis2.h"
-#include "uf3_bspline_basis3.h"
+#include "uf3_simd.h"
 
 #include "utils.h"
 #include "error.h"
@@ -13,112 +12,89 @@ using namespace LAMMPS_NS;
 uf3_pair_bspline::uf3_pair_bspline() {}
 
 // Constructor
-// Passing vectors by reference
+// Passing vectors by reference, only the table built from them is kept
 uf3_pair_bspline::uf3_pair_bspline(LAMMPS *ulmp, const std::vector<double> &uknot_vect,
                                    const std::vector<double> &ucoeff_vect, 
                                    const int &uknot_spacing_type)
 {
   lmp = ulmp;
-  knot_vect = uknot_vect;
-  coeff_vect = ucoeff_vect;
   
   knot_spacing_type = uknot_spacing_type;
-  if (knot_spacing_type==0){
-    knot_spacing = knot_vect[4]-knot_vect[3];
-    get_starting_index=&uf3_pair_bspline::get_starting_index_uniform;
-  }
-  else if (knot_spacing_type==1){
+  if (knot_spacing_type==0)
+    knot_spacing = uknot_vect[4]-uknot_vect[3];
+  else if (knot_spacing_type==1)
     knot_spacing = 0;
-    get_starting_index=&uf3_pair_bspline::get_starting_index_nonuniform;
-  }
-
   else
     lmp->error->all(FLERR, "UF3: Expected either '0'(uniform-knots) or \n\
             '1'(non-uniform knots)");
   
   knot_vect_size = uknot_vect.size();
   coeff_vect_size = ucoeff_vect.size();
-  
-  // Initialize B-Spline Basis Functions
-  for (int i = 0; i < knot_vect.size() - 4; i++)
-    bspline_bases.push_back(uf3_bspline_basis3(lmp, &knot_vect[i], coeff_vect[i]));
 
-  // Initialize Coefficients and Knots for Derivatives
-  // The last coefficient needs to be droped
-  for (int i = 0; i < coeff_vect_size - 1; i++) {
-    double dntemp4 = 3 / (knot_vect[i + 4] - knot_vect[i + 1]);
-    dncoeff_vect.push_back((coeff_vect[i + 1] - coeff_vect[i]) * dntemp4);
-  }
-  //What we have is a clamped bspline -->i.e value of the bspline curve at the 
-  //knots with multiplicity equal to the degree of bspline is equal to the coefficient
-  //
-  //Therefore for the derivative bspline the very first and last knot needs to be droped
-  //to change their multiplicity from 4 (necessary condition for clamped cubic bspline)
-  //to 3 (necessary condition for clamped quadratic bspline)
-  //
-  //Also if the coeff vector size of decreases by 1 for the derivative bspline
-  //knots size needs to go down by 2 as ==> knots = coefficient + degree + 1
-  for (int i = 1; i < knot_vect_size - 1; i++) dnknot_vect.push_back(knot_vect[i]);
-
-  // Initialize B-Spline Derivative Basis Functions
-  for (int i = 0; i < dnknot_vect.size() - 3; i++)
-    dnbspline_bases.push_back(uf3_bspline_basis2(lmp, &dnknot_vect[i], dncoeff_vect[i]));
+  // The 4 bases that are non-zero on a knot interval are summed, weighted
+  // with their coefficients, into a single cubic per interval. Its
+  // derivative is stored as a quadratic next to it.
+  table = uf3_interval_table(lmp, uknot_vect, knot_spacing_type, ucoeff_vect);
 }
 
 uf3_pair_bspline::~uf3_pair_bspline() {}
 
-int uf3_pair_bspline::get_starting_index_uniform(double r)
+// Evaluate energy and its derivative at r, results are written to
+// ret_val[0] and ret_val[1]. No member is modified so several threads
+// can evaluate the same spline concurrently.
+void uf3_pair_bspline::eval(double r, double *ret_val)
 {
-  return 3+(int)((r-knot_vect[0])/knot_spacing);
+  if (knot_spacing_type == 0)
+    eval_spline<1, 0>(r, ret_val);
+  else
+    eval_spline<1, 1>(r, ret_val);
 }
 
-int uf3_pair_bspline::get_starting_index_nonuniform(double r)
+// Only evaluate the derivative into ret_val[1], ret_val[0] is left untouched
+void uf3_pair_bspline::eval_deriv(double r, double *ret_val)
 {
-  if (knot_vect.front() <= r && r < knot_vect.back()) {
-    //Determine the interval for value_rij
-    for (int i = 3; i < knot_vect_size - 1; ++i) {
-      if (knot_vect[i] <= r && r < knot_vect[i + 1]) {
-        return i;
-      }
-    }
-  }
+  if (knot_spacing_type == 0)
+    eval_spline<0, 0>(r, ret_val);
+  else
+    eval_spline<0, 1>(r, ret_val);
 }
 
-double *uf3_pair_bspline::eval(double r)
+template <int EFLAG, int SPACING> void uf3_pair_bspline::eval_spline(double r, double *ret_val)
 {
+  double energy, deriv;
+  table.eval<SPACING>(r, energy, deriv);
+  if (EFLAG) ret_val[0] = energy;
+  ret_val[1] = deriv;
+}
 
-  // Find knot starting position
-
-  int start_index=(this->*get_starting_index)(r);
-  /*if (knot_vect.front() <= r && r < knot_vect.back()) {
-    //Determine the interval for value_rij
-    for (int i = 3; i < knot_vect_size - 1; ++i) {
-      if (knot_vect[i] <= r && r < knot_vect[i + 1]) {
-        start_index = i;
-        break;
-      }
-    }
-  }*/
-
-  int knot_affect_start = start_index - 3;
-
-  double rsq = r * r;
-  double rth = rsq * r;
-
-  // Calculate energy
-
-  ret_val[0] = bspline_bases[knot_affect_start + 3].eval0(rth, rsq, r);
-  ret_val[0] += bspline_bases[knot_affect_start + 2].eval1(rth, rsq, r);
-  ret_val[0] += bspline_bases[knot_affect_start + 1].eval2(rth, rsq, r);
-  ret_val[0] += bspline_bases[knot_affect_start].eval3(rth, rsq, r);
-
-  // Calculate force
-
-  ret_val[1] = dnbspline_bases[knot_affect_start + 2].eval0(rsq, r);
-  ret_val[1] += dnbspline_bases[knot_affect_start + 1].eval1(rsq, r);
-  ret_val[1] += dnbspline_bases[knot_affect_start].eval2(rsq, r);
+// Evaluate the spline at the n distances r[], the derivatives are written to
+// dedr[] and the energies to e[] unless e is a nullptr. The loop over n runs
+// on the per interval cubics and is vectorizable.
+void uf3_pair_bspline::eval_batch(const double *r, int n, double *e, double *dedr)
+{
+  if (knot_spacing_type == 0) {
+    if (e)
+      eval_batch_spline<1, 0>(r, n, e, dedr);
+    else
+      eval_batch_spline<0, 0>(r, n, e, dedr);
+  } else {
+    if (e)
+      eval_batch_spline<1, 1>(r, n, e, dedr);
+    else
+      eval_batch_spline<0, 1>(r, n, e, dedr);
+  }
+}
 
-  return ret_val;
+template <int EFLAG, int SPACING>
+void uf3_pair_bspline::eval_batch_spline(const double *r, int n, double *e, double *dedr)
+{
+  UF3_SIMD
+  for (int m = 0; m < n; m++) {
+    double energy, deriv;
+    table.eval<SPACING>(r[m], energy, deriv);
+    if (EFLAG) e[m] = energy;
+    dedr[m] = deriv;
+  }
 }
 
 double uf3_pair_bspline::memory_usage()
@@ -127,18 +103,7 @@ double uf3_pair_bspline::memory_usage()
 
   bytes += (double)2*sizeof(int);                           //knot_vect_size,
                                                             //coeff_vect_size
-  bytes += (double)knot_vect.size()*sizeof(double);         //knot_vect
-  bytes += (double)dnknot_vect.size()*sizeof(double);       //dnknot_vect
-  bytes += (double)coeff_vect.size()*sizeof(double);        //coeff_vect
-  bytes += (double)dncoeff_vect.size()*sizeof(double);      //dncoeff_vect
-
-  for (int i = 0; i < knot_vect.size() - 4; i++)
-    bytes += (double)bspline_bases[i].memory_usage();       //bspline_basis3
-
-  for (int i = 0; i < dnknot_vect.size() - 3; i++)
-    bytes += (double)dnbspline_bases[i].memory_usage();     //bspline_basis2
-
-  bytes += (double)2*sizeof(double);    //ret_val
+  bytes += (double)table.memory_usage();                    //table
 
   return bytes;
 }
@@ -9,15 +9,16 @@
    See the README file in the top-level LAMMPS directory.
 ------------------------------------------------------------------------- */
 
-// De Boor's algorithm @
-// https://pages.mtu.edu/~shene/COURSES/cs3621/NOTES/spline/B-spline/de-Boor.html
-// For values outside the domain, it exhibits undefined behavior.
-// Uses fixed B-Spline degree 3.
+// Cubic B-spline of the 2-body term, stored as one cubic in r per knot
+// interval (the 4 non-zero bases summed with their coefficients) and its
+// derivative, see uf3_interval_table. The interval of r is found directly
+// for uniform knots and through buckets (or a scan) otherwise. r outside
+// the knots is clamped to the first or last interval, whose cubic is then
+// extrapolated.
 
 #include "pointers.h"
 
-#include "uf3_bspline_basis2.h"
-#include "uf3_bspline_basis3.h"
+#include "uf3_interval_table.h"
 
 #include <vector>
 
@@ -29,12 +30,12 @@ namespace LAMMPS_NS {
 class uf3_pair_bspline {
  private:
   int knot_vect_size, coeff_vect_size;
-  std::vector<double> knot_vect, dnknot_vect;
-  std::vector<double> coeff_vect, dncoeff_vect;
-  std::vector<uf3_bspline_basis3> bspline_bases;
-  std::vector<uf3_bspline_basis2> dnbspline_bases;
-  int get_starting_index_uniform(double), get_starting_index_nonuniform(double);
-  int (uf3_pair_bspline::*get_starting_index)(double);
+  // the kernels are specialized on the knot spacing type, the public
+  // functions select them once per call
+  template <int EFLAG, int SPACING> void eval_spline(double, double *);
+  uf3_interval_table table;    // one cubic per knot interval
+  template <int EFLAG, int SPACING>
+  void eval_batch_spline(const double *, int, double *, double *);
   //double knot_spacing=0; 
   LAMMPS *lmp;
 
@@ -47,8 +48,9 @@ class uf3_pair_bspline {
   ~uf3_pair_bspline();
   int knot_spacing_type;
   double knot_spacing=0;
-  double ret_val[2];
-  double *eval(double value_rij);
+  void eval(double value_rij, double *ret_val);
+  void eval_deriv(double value_rij, double *ret_val);
+  void eval_batch(const double *r, int n, double *e, double *dedr);
   double memory_usage();
 };
 }    // namespace LAMMPS_NS
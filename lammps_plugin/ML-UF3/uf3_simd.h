@@ -0,0 +1,29 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/ Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+// Loops over independent spline evaluations are marked with "omp simd".
+// Compile with -fopenmp-simd (or -fopenmp, -qopenmp-simd) to enable it,
+// otherwise the loops are left to the compiler's auto-vectorization.
+//
+
+#ifndef UF3_SIMD_H
+#define UF3_SIMD_H
+
+#if defined(_OPENMP) || defined(LMP_SIMD_COMPILER)
+#define UF3_PRAGMA(x) _Pragma(#x)
+#define UF3_SIMD UF3_PRAGMA(omp simd)
+#define UF3_SIMD_SUM(...) UF3_PRAGMA(omp simd reduction(+ : __VA_ARGS__))
+#else
+#define UF3_SIMD
+#define UF3_SIMD_SUM(...)
+#endif
+
+#endif
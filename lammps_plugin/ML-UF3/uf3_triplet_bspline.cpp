@@ -1,6 +1,10 @@
 #include "uf3_triplet_bspline.h"
+#include "uf3_simd.h"
+#include "comm.h"
 #include "error.h"
-#include <iostream>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <vector>
 
 using namespace LAMMPS_NS;
@@ -10,288 +14,703 @@ uf3_triplet_bspline::uf3_triplet_bspline(){};
 
 // Construct a new 3D B-Spline
 uf3_triplet_bspline::uf3_triplet_bspline(
-    LAMMPS *ulmp, const std::vector<std::vector<double>> &uknot_matrix,
-    const std::vector<std::vector<std::vector<double>>> &ucoeff_matrix,
-    const int &uknot_spacing_type)
+    LAMMPS *ulmp, const std::vector<double> &uknots_jk, const std::vector<double> &uknots_ik,
+    const std::vector<double> &uknots_ij, const uf3_tensor_view &ucoeff,
+    const int &uknot_spacing_type, int ulayout, int urepr, int uprec, int ustore)
 {
   lmp = ulmp;
-  knot_matrix = uknot_matrix;
-  coeff_matrix = ucoeff_matrix;
 
   knot_spacing_type = uknot_spacing_type;
   if (knot_spacing_type==0){
-    knot_spacing_ij = knot_matrix[2][4]-knot_matrix[2][3];
-    knot_spacing_ik = knot_matrix[1][4]-knot_matrix[1][3];
-    knot_spacing_jk = knot_matrix[0][4]-knot_matrix[0][3];
-    get_starting_index=&uf3_triplet_bspline::get_starting_index_uniform;
+    knot_spacing_ij = uknots_ij[4]-uknots_ij[3];
+    knot_spacing_ik = uknots_ik[4]-uknots_ik[3];
+    knot_spacing_jk = uknots_jk[4]-uknots_jk[3];
   }
   else if (knot_spacing_type==1){
     knot_spacing_ij = 0;
     knot_spacing_ik = 0;
     knot_spacing_jk = 0;
-    get_starting_index=&uf3_triplet_bspline::get_starting_index_nonuniform;
   }
 
   else
     lmp->error->all(FLERR, "UF3: Expected either '0'(uniform-knots) or \n\
             '1'(non-uniform knots)");
 
-  knot_vect_size_ij = knot_matrix[2].size();
-  knot_vect_size_ik = knot_matrix[1].size();
-  knot_vect_size_jk = knot_matrix[0].size();
+  knot_vect_size_ij = uknots_ij.size();
+  knot_vect_size_ik = uknots_ik.size();
+  knot_vect_size_jk = uknots_jk.size();
+
+  // Copy the coefficients into the flat tensor
+  dim_ij = ucoeff.dim[0];
+  dim_ik = ucoeff.dim[1];
+  dim_jk = ucoeff.dim[2];
+  set_layout(ulayout);
+
+  for (int i = 0; i < dim_ij; i++)
+    for (int j = 0; j < dim_ik; j++)
+      for (int k = 0; k < dim_jk; k++)
+        coeff[offset_ij[i] + offset_ik[j] + offset_jk[k]] = ucoeff(i, j, k);
+
+  // Per interval cubics of the bases and their derivatives. The derivatives
+  // of the spline are contractions of the same coefficients with the
+  // derivatives of the bases, so no derivative tensors are stored. The
+  // knots themselves are not kept, the tables hold all that is evaluated.
+  table_ij = uf3_interval_table(lmp, uknots_ij, knot_spacing_type, std::vector<double>());
+  table_ik = uf3_interval_table(lmp, uknots_ik, knot_spacing_type, std::vector<double>());
+  table_jk = uf3_interval_table(lmp, uknots_jk, knot_spacing_type, std::vector<double>());
+
+  repr = urepr;
+  if (repr == REPR_TRICUBIC)
+    set_tricubic();
+  else if (repr != REPR_BSPLINE)
+    lmp->error->all(FLERR, "UF3: Unknown representation {} for the 3-body spline", repr);
+
+  // multiply-adds to build a slab over those saved per triplet by eval_slab()
+  if (repr == REPR_TRICUBIC)
+    slab_min = 1 + (96 * table_ik.nint * table_jk.nint) / 192;
+  else
+    slab_min = 1 + (8 * dim_ik * dim_jk) / 192;
+
+  prec = uprec;
+  if ((prec != PREC_DOUBLE) && (prec != PREC_MIXED))
+    lmp->error->all(FLERR, "UF3: Unknown precision {} for the 3-body spline", prec);
+  store = ustore;
+  if ((store != STORE_DOUBLE) && (store != STORE_FLOAT) && (store != STORE_INT16))
+    lmp->error->all(FLERR, "UF3: Unknown storage {} for the 3-body spline", store);
+  set_storage();
+}
 
-  int resolution_ij = knot_vect_size_ij - 4;
-  int resolution_ik = knot_vect_size_ik - 4;
-  int resolution_jk = knot_vect_size_jk - 4;
+// Destructor
+uf3_triplet_bspline::~uf3_triplet_bspline() {}
 
-  // Cache Spline Basis Functions
-  for (int l = 0; l < resolution_ij; l++) {
-    bsplines_ij.push_back(uf3_bspline_basis3(lmp, &knot_matrix[2][l], 1));
-  }
+// Set up the per dimension offsets of the flat tensor and allocate it.
+// With LAYOUT_BLOCKED the 4x4x4 coefficients a knot cell depends on touch at
+// most 8 tiles of 8 cache lines each, independent of the tensor shape.
+void uf3_triplet_bspline::set_layout(int ulayout)
+{
+  layout = ulayout;
+  offset_ij.resize(dim_ij);
+  offset_ik.resize(dim_ik);
+  offset_jk.resize(dim_jk);
+
+  int size;
+  if (layout == LAYOUT_LINEAR) {
+    const int stride_ik = (dim_jk + 7) & ~7;
+    const int stride_ij = dim_ik * stride_ik;
+    for (int i = 0; i < dim_ij; i++) offset_ij[i] = i * stride_ij;
+    for (int j = 0; j < dim_ik; j++) offset_ik[j] = j * stride_ik;
+    for (int k = 0; k < dim_jk; k++) offset_jk[k] = k;
+    size = dim_ij * stride_ij;
+  } else if (layout == LAYOUT_BLOCKED) {
+    const int ntile_ij = (dim_ij + 3) / 4;
+    const int ntile_ik = (dim_ik + 3) / 4;
+    const int ntile_jk = (dim_jk + 3) / 4;
+    for (int i = 0; i < dim_ij; i++) offset_ij[i] = (i / 4) * ntile_ik * ntile_jk * 64 + (i % 4) * 16;
+    for (int j = 0; j < dim_ik; j++) offset_ik[j] = (j / 4) * ntile_jk * 64 + (j % 4) * 4;
+    for (int k = 0; k < dim_jk; k++) offset_jk[k] = (k / 4) * 64 + (k % 4);
+    size = ntile_ij * ntile_ik * ntile_jk * 64;
+  } else
+    lmp->error->all(FLERR, "UF3: Unknown layout {} for the 3-body coefficients", layout);
+
+  coeff.assign(size, 0.0);
+}
 
-  for (int l = 0; l < resolution_ik; l++) {
-    // Reuse jk Basis if Knots match
-    if (knot_matrix[1][l] == knot_matrix[2][l] && knot_matrix[1][l + 1] == knot_matrix[2][l + 1] &&
-        knot_matrix[1][l + 2] == knot_matrix[2][l + 2] &&
-        knot_matrix[1][l + 3] == knot_matrix[2][l + 3])
-      bsplines_ik.push_back(bsplines_ij[l]);
-    else
-      bsplines_ik.push_back(uf3_bspline_basis3(lmp, &knot_matrix[1][l], 1));
+// Expand the spline on every knot cell into a tricubic polynomial in the
+// offsets from the lower cell corner. The 64 bases that are non-zero on a
+// cell are each a product of three cubics, summing them weighted with their
+// coefficients gives the 64 power basis coefficients of the cell. The
+// cells are independent and split over the OpenMP threads of the rank,
+// unless the spline is already built by one of several threads, see
+// PairUF3::create_bsplines().
+void uf3_triplet_bspline::set_tricubic()
+{
+  const int nij = table_ij.nint;
+  const int nik = table_ik.nint;
+  const int njk = table_jk.nint;
+  tricubic.assign((size_t) 64 * nij * nik * njk, 0.0);
+
+#if defined(_OPENMP)
+#pragma omp parallel for schedule(static) num_threads(lmp->comm->nthreads)
+#endif
+  for (int a = 0; a < nij; a++) {
+    const double *bij = &table_ij.basis[16 * a];
+    for (int b = 0; b < nik; b++) {
+      const double *bik = &table_ik.basis[16 * b];
+      for (int c = 0; c < njk; c++) {
+        const double *bjk = &table_jk.basis[16 * c];
+        double *cell = &tricubic[(size_t) 64 * ((a * nik + b) * njk + c)];
+
+        for (int i = 0; i < 4; i++) {
+          for (int j = 0; j < 4; j++) {
+            // contract the 4 coefficients along jk first
+            double w[4] = {0, 0, 0, 0};
+            for (int k = 0; k < 4; k++) {
+              const double cijk = coeff[offset_ij[a + i] + offset_ik[b + j] + offset_jk[c + k]];
+              for (int s = 0; s < 4; s++) w[s] += cijk * bjk[4 * k + s];
+            }
+            for (int p = 0; p < 4; p++)
+              for (int q = 0; q < 4; q++) {
+                const double f = bij[4 * i + p] * bik[4 * j + q];
+                for (int s = 0; s < 4; s++) cell[16 * p + 4 * q + s] += f * w[s];
+              }
+          }
+        }
+      }
+    }
   }
+}
 
-  for (int l = 0; l < resolution_jk; l++) {
-    bsplines_jk.push_back(uf3_bspline_basis3(lmp, &knot_matrix[0][l], 1));
+// Pack a tensor into 16-bit integers with one power of two scale per 64
+// elements, chosen so the largest element of the block maps to at most
+// 32767. The absolute error is at most half a scale, i.e. about 3e-5 of
+// the largest coefficient of the block.
+static void pack_int16(const std::vector<double, uf3_aligned_allocator<double>> &x,
+                       std::vector<int16_t, uf3_aligned_allocator<int16_t>> &q,
+                       std::vector<float> &scale)
+{
+  const size_t n = x.size();
+  q.assign(n, 0);
+  scale.assign((n + 63) / 64, 1.0f);
+  for (size_t b = 0; b < scale.size(); b++) {
+    const size_t end = (64 * b + 64 < n) ? 64 * b + 64 : n;
+    double xmax = 0.0;
+    for (size_t m = 64 * b; m < end; m++) xmax = std::max(xmax, std::fabs(x[m]));
+    if (xmax == 0.0) continue;
+    int e;
+    std::frexp(xmax / 32767.0, &e);
+    scale[b] = std::ldexp(1.0f, std::max(e, FLT_MIN_EXP));
+    for (size_t m = 64 * b; m < end; m++) q[m] = static_cast<int16_t>(std::lround(x[m] / scale[b]));
   }
+}
 
-  // Initialize Coefficients for Derivatives
-  for (int i = 0; i < coeff_matrix.size(); i++) {
-    std::vector<std::vector<double>> dncoeff_vect2;
-    for (int j = 0; j < coeff_matrix[0].size(); j++) {
-      std::vector<double> dncoeff_vect;
-      for (int k = 0; k < coeff_matrix[0][0].size() - 1; k++) {
-        double dntemp4 = 3 / (knot_matrix[0][k + 4] - knot_matrix[0][k + 1]);
-        dncoeff_vect.push_back((coeff_matrix[i][j][k + 1] - coeff_matrix[i][j][k]) * dntemp4);
-      }
-      dncoeff_vect2.push_back(dncoeff_vect);
-    }
-    dncoeff_matrix_jk.push_back(dncoeff_vect2);
+// Copies of the tensors in the format the kernels read. PREC_MIXED reads
+// single precision bases and, unless they are packed into integers, single
+// precision coefficients. The knots stay in double, so the intervals are
+// found as in PREC_DOUBLE and only the offsets into them are rounded.
+// The double tensors are only kept for PREC_DOUBLE with STORE_DOUBLE, no
+// other combination reads them.
+// The power basis coefficients of a tricubic cell span orders of magnitude
+// and cancel each other, so they lose too much with a scale per 64 of them
+// and are kept in single precision with STORE_INT16.
+void uf3_triplet_bspline::set_storage()
+{
+  if (prec == PREC_MIXED) {
+    table_ij.set_single();
+    table_ik.set_single();
+    table_jk.set_single();
   }
 
-  for (int i = 0; i < coeff_matrix.size(); i++) {
-    std::vector<std::vector<double>> dncoeff_vect2;
-    for (int j = 0; j < coeff_matrix[0].size() - 1; j++) {
-      double dntemp4 = 3 / (knot_matrix[1][j + 4] - knot_matrix[1][j + 1]);
-      std::vector<double> dncoeff_vect;
-      for (int k = 0; k < coeff_matrix[0][0].size(); k++) {
-        dncoeff_vect.push_back((coeff_matrix[i][j + 1][k] - coeff_matrix[i][j][k]) * dntemp4);
-      }
-      dncoeff_vect2.push_back(dncoeff_vect);
-    }
-    dncoeff_matrix_ik.push_back(dncoeff_vect2);
-  }
+  const int single = (store == STORE_FLOAT) || ((store == STORE_DOUBLE) && (prec == PREC_MIXED));
+  if (single) coeff_f.assign(coeff.begin(), coeff.end());
+  if (single || (store == STORE_INT16)) tricubic_f.assign(tricubic.begin(), tricubic.end());
+  if (store == STORE_INT16) pack_int16(coeff, coeff_q, coeff_scale);
 
-  for (int i = 0; i < coeff_matrix.size() - 1; i++) {
-    std::vector<std::vector<double>> dncoeff_vect2;
-    double dntemp4 = 3 / (knot_matrix[2][i + 4] - knot_matrix[2][i + 1]);
-    for (int j = 0; j < coeff_matrix[0].size(); j++) {
-      std::vector<double> dncoeff_vect;
-      for (int k = 0; k < coeff_matrix[0][0].size(); k++) {
-        dncoeff_vect.push_back((coeff_matrix[i + 1][j][k] - coeff_matrix[i][j][k]) * dntemp4);
-      }
-      dncoeff_vect2.push_back(dncoeff_vect);
-    }
-    dncoeff_matrix_ij.push_back(dncoeff_vect2);
+  if ((store != STORE_DOUBLE) || (prec != PREC_DOUBLE)) {
+    std::vector<double, uf3_aligned_allocator<double>>().swap(coeff);
+    std::vector<double, uf3_aligned_allocator<double>>().swap(tricubic);
   }
+}
 
-  std::vector<std::vector<double>> dnknot_matrix;
-  for (int i = 0; i < knot_matrix.size(); i++) {
-    std::vector<double> dnknot_vect;
-    for (int j = 1; j < knot_matrix[0].size() - 1; j++) {
-      dnknot_vect.push_back(knot_matrix[i][j]);
+// Value and derivatives of the tricubic of the cell containing the triplet,
+// nested Horner schemes along jk, ik and ij
+template <int EFLAG, int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_tricubic(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                                        double value_rjk, double *ret_val)
+{
+  const int a = ij.idx;
+  const int b = ik.idx;
+  const int c = table_jk.interval<SPACING>(value_rjk);
+  const T u = ij.u;
+  const T v = ik.u;
+  const T w = value_rjk - table_jk.tlow[c];
+  const auto t = tricubic_reader<T, S>();
+  const size_t cell = (size_t) 64 * ((a * table_ik.nint + b) * table_jk.nint + c);
+
+  T e = 0, du = 0, dv = 0, dw = 0;
+  for (int p = 3; p >= 0; p--) {
+    T g = 0, gv = 0, gw = 0;
+    for (int q = 3; q >= 0; q--) {
+      const size_t cs = cell + 16 * p + 4 * q;
+      const T f = ((t[cs + 3] * w + t[cs + 2]) * w + t[cs + 1]) * w + t[cs];
+      const T fw = (3 * t[cs + 3] * w + 2 * t[cs + 2]) * w + t[cs + 1];
+      gv = gv * v + g;
+      g = g * v + f;
+      gw = gw * v + fw;
     }
-    dnknot_matrix.push_back(dnknot_vect);
+    du = du * u + e;
+    e = e * u + g;
+    dv = dv * u + gv;
+    dw = dw * u + gw;
   }
 
-  // Cache Derivative Spline Basis Functions
-  for (int l = 0; l < resolution_ij - 1; l++) {
-    dnbsplines_ij.push_back(uf3_bspline_basis2(lmp, &dnknot_matrix[2][l], 1));
-  }
+  if (EFLAG) ret_val[0] = e;
+  ret_val[1] = du;
+  ret_val[2] = dv;
+  ret_val[3] = dw;
+}
 
-  for (int l = 0; l < resolution_ik - 1; l++) {
-    // Reuse jk Basis if Knots match
-    if (dnknot_matrix[1][l] == dnknot_matrix[2][l] &&
-        dnknot_matrix[1][l + 1] == dnknot_matrix[2][l + 1] &&
-        dnknot_matrix[1][l + 2] == dnknot_matrix[2][l + 2])
-      dnbsplines_ik.push_back(dnbsplines_ij[l]);
-    else
-      dnbsplines_ik.push_back(uf3_bspline_basis2(lmp, &dnknot_matrix[1][l], 1));
-  }
+// Evaluate 3D B-Spline value
+// ret_val[0] receives the energy and ret_val[1..3] its derivatives with respect
+// to rij, rik and rjk. The spline itself is not modified, so it is safe to call
+// from several threads at once.
+void uf3_triplet_bspline::eval(double value_rij, double value_rik, double value_rjk,
+                               double *ret_val)
+{
+  if (knot_spacing_type == 0)
+    eval_kernel<1, 0>(value_rij, value_rik, value_rjk, ret_val);
+  else
+    eval_kernel<1, 1>(value_rij, value_rik, value_rjk, ret_val);
+}
 
-  for (int l = 0; l < resolution_jk - 1; l++) {
-    dnbsplines_jk.push_back(uf3_bspline_basis2(lmp, &dnknot_matrix[0][l], 1));
-  }
+// Same as eval() but only the derivatives ret_val[1..3] are computed,
+// the energy contraction is skipped and ret_val[0] is left untouched
+void uf3_triplet_bspline::eval_deriv(double value_rij, double value_rik, double value_rjk,
+                                     double *ret_val)
+{
+  if (knot_spacing_type == 0)
+    eval_kernel<0, 0>(value_rij, value_rik, value_rjk, ret_val);
+  else
+    eval_kernel<0, 1>(value_rij, value_rik, value_rjk, ret_val);
 }
 
-// Destructor
-uf3_triplet_bspline::~uf3_triplet_bspline() {}
+// Same as eval() with the ij and ik axes from bases_ij() and bases_ik()
+void uf3_triplet_bspline::eval(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                               double value_rjk, double *ret_val)
+{
+  if (knot_spacing_type == 0)
+    eval_kernel<1, 0>(ij, ik, value_rjk, ret_val);
+  else
+    eval_kernel<1, 1>(ij, ik, value_rjk, ret_val);
+}
 
-// Evaluate 3D B-Spline value
-double *uf3_triplet_bspline::eval(double value_rij, double value_rik, double value_rjk)
+// The tricubic only needs the intervals of rij and rik, the B-spline also
+// the bases along ij and ik
+void uf3_triplet_bspline::bases_ij(double value_rij, uf3_axis_bases &ij) const
+{
+  if (knot_spacing_type == 0)
+    axis_bases<0>(table_ij, value_rij, ij);
+  else
+    axis_bases<1>(table_ij, value_rij, ij);
+}
+
+void uf3_triplet_bspline::bases_ik(double value_rik, uf3_axis_bases &ik) const
 {
+  if (knot_spacing_type == 0)
+    axis_bases<0>(table_ik, value_rik, ik);
+  else
+    axis_bases<1>(table_ik, value_rik, ik);
+}
 
-  // Find starting knots
-
-  //int iknot_ij = starting_knot(knot_matrix[2], knot_vect_size_ij, value_rij) - 3;
-  //int iknot_ik = starting_knot(knot_matrix[1], knot_vect_size_ik, value_rik) - 3;
-  //int iknot_jk = starting_knot(knot_matrix[0], knot_vect_size_jk, value_rjk) - 3;
-  int iknot_ij = (this->*get_starting_index)(knot_matrix[2], knot_vect_size_ij, value_rij,knot_spacing_ij) - 3;
-  int iknot_ik = (this->*get_starting_index)(knot_matrix[1], knot_vect_size_ik, value_rik,knot_spacing_ik) - 3;
-  int iknot_jk = (this->*get_starting_index)(knot_matrix[0], knot_vect_size_jk, value_rjk,knot_spacing_jk) - 3;
-
-  double rsq_ij = value_rij * value_rij;
-  double rsq_ik = value_rik * value_rik;
-  double rsq_jk = value_rjk * value_rjk;
-  double rth_ij = rsq_ij * value_rij;
-  double rth_ik = rsq_ik * value_rik;
-  double rth_jk = rsq_jk * value_rjk;
-
-  // Calculate energies
-
-  double basis_ij[4];
-  basis_ij[0] = bsplines_ij[iknot_ij].eval3(rth_ij, rsq_ij, value_rij);
-  basis_ij[1] = bsplines_ij[iknot_ij + 1].eval2(rth_ij, rsq_ij, value_rij);
-  basis_ij[2] = bsplines_ij[iknot_ij + 2].eval1(rth_ij, rsq_ij, value_rij);
-  basis_ij[3] = bsplines_ij[iknot_ij + 3].eval0(rth_ij, rsq_ij, value_rij);
-
-  double basis_ik[4];
-  basis_ik[0] = bsplines_ik[iknot_ik].eval3(rth_ik, rsq_ik, value_rik);
-  basis_ik[1] = bsplines_ik[iknot_ik + 1].eval2(rth_ik, rsq_ik, value_rik);
-  basis_ik[2] = bsplines_ik[iknot_ik + 2].eval1(rth_ik, rsq_ik, value_rik);
-  basis_ik[3] = bsplines_ik[iknot_ik + 3].eval0(rth_ik, rsq_ik, value_rik);
-
-  double basis_jk[4];
-  basis_jk[0] = bsplines_jk[iknot_jk].eval3(rth_jk, rsq_jk, value_rjk);
-  basis_jk[1] = bsplines_jk[iknot_jk + 1].eval2(rth_jk, rsq_jk, value_rjk);
-  basis_jk[2] = bsplines_jk[iknot_jk + 2].eval1(rth_jk, rsq_jk, value_rjk);
-  basis_jk[3] = bsplines_jk[iknot_jk + 3].eval0(rth_jk, rsq_jk, value_rjk);
-
-  ret_val[0] = 0;
-  ret_val[1] = 0;
-  ret_val[2] = 0;
-  ret_val[3] = 0;
+template <int SPACING>
+void uf3_triplet_bspline::axis_bases(const uf3_interval_table &table, double value_r,
+                                     uf3_axis_bases &ab) const
+{
+  if (repr == REPR_TRICUBIC)
+    table.locate<SPACING>(value_r, ab);
+  else
+    table.eval_bases<SPACING>(value_r, ab);
+}
+
+template <int EFLAG, int SPACING>
+void uf3_triplet_bspline::eval_kernel(double value_rij, double value_rik, double value_rjk,
+                                      double *ret_val)
+{
+  uf3_axis_bases ij, ik;
+  axis_bases<SPACING>(table_ij, value_rij, ij);
+  axis_bases<SPACING>(table_ik, value_rik, ik);
+  eval_kernel<EFLAG, SPACING>(ij, ik, value_rjk, ret_val);
+}
+
+template <int EFLAG, int SPACING>
+void uf3_triplet_bspline::eval_kernel(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                                      double value_rjk, double *ret_val)
+{
+  if (prec == PREC_MIXED) {
+    if (store == STORE_INT16)
+      eval_kernel<EFLAG, SPACING, float, int16_t>(ij, ik, value_rjk, ret_val);
+    else
+      eval_kernel<EFLAG, SPACING, float, float>(ij, ik, value_rjk, ret_val);
+  } else {
+    if (store == STORE_INT16)
+      eval_kernel<EFLAG, SPACING, double, int16_t>(ij, ik, value_rjk, ret_val);
+    else if (store == STORE_FLOAT)
+      eval_kernel<EFLAG, SPACING, double, float>(ij, ik, value_rjk, ret_val);
+    else
+      eval_kernel<EFLAG, SPACING, double, double>(ij, ik, value_rjk, ret_val);
+  }
+}
+
+template <int EFLAG, int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_kernel(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                                      double value_rjk, double *ret_val)
+{
+  if (repr == REPR_TRICUBIC)
+    eval_tricubic<EFLAG, SPACING, T, S>(ij, ik, value_rjk, ret_val);
+  else if (layout == LAYOUT_LINEAR)
+    eval_spline<EFLAG, LAYOUT_LINEAR, SPACING, T, S>(ij, ik, value_rjk, ret_val);
+  else
+    eval_spline<EFLAG, LAYOUT_BLOCKED, SPACING, T, S>(ij, ik, value_rjk, ret_val);
+}
 
+template <int EFLAG, int LAYOUT, int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_spline(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                                      double value_rjk, double *ret_val)
+{
+  // values and derivatives of the 4 bases per direction that are non-zero,
+  // those along ij and ik are given
+
+  T basis_ij[4], dnbasis_ij[4];
+  T basis_ik[4], dnbasis_ik[4];
+  T basis_jk[4], dnbasis_jk[4];
+  for (int m = 0; m < 4; m++) {
+    basis_ij[m] = ij.b[m];
+    dnbasis_ij[m] = ij.db[m];
+    basis_ik[m] = ik.b[m];
+    dnbasis_ik[m] = ik.db[m];
+  }
+  const int iknot_ij = ij.idx;
+  const int iknot_ik = ik.idx;
+  const int iknot_jk = table_jk.eval_bases<SPACING>(value_rjk, basis_jk, dnbasis_jk);
+
+  // offsets of the rows/columns this knot cell depends on. the 4 entries
+  // along jk are contiguous in the linear layout, known at compile time
+  const int *oij = &offset_ij[iknot_ij];
+  const int *oik = &offset_ik[iknot_ik];
+  const int ojk0 = offset_jk[iknot_jk];
+  int ojk[4];
+  for (int k = 0; k < 4; k++)
+    ojk[k] = (LAYOUT == LAYOUT_LINEAR) ? k : offset_jk[iknot_jk + k] - ojk0;
+
+  // one pass over the 64 coefficients gives the energy and all derivatives
+
+  const uf3_tensor_reader<T, S> c = coeff_reader<T, S>();
+  T energy = 0, dij = 0, dik = 0, djk = 0;
   for (int i = 0; i < 4; i++) {
-    const double basis_iji = basis_ij[i]; // prevent repeated access of same memory location
     for (int j = 0; j < 4; j++) {
-      const double factor = basis_iji * basis_ik[j]; // prevent repeated access of same memory location
-      const double* slice = &coeff_matrix[i + iknot_ij][j + iknot_ik][iknot_jk]; // declare a contigues 1D slice of memory
-      double tmp[4]; // declare tmp array that holds the 4 tmp values so the can be computed simultaniously in 4 separate registeres.
-      tmp[0] = slice[0] * basis_jk[0];
-      tmp[1] = slice[1] * basis_jk[1];
-      tmp[2] = slice[2] * basis_jk[2];
-      tmp[3] = slice[3] * basis_jk[3];
-      double sum = tmp[0] + tmp[1] + tmp[2] + tmp[3];
-      ret_val[0] += factor * sum; // use 1 fused multiply-add (FMA)
+      const int slice = oij[i] + oik[j] + ojk0;    // 1D slice along jk
+      T sum = 0, dsum = 0;
+      for (int k = 0; k < 4; k++) {
+        const T ck = c[slice + ojk[k]];
+        sum += ck * basis_jk[k];
+        dsum += ck * dnbasis_jk[k];
+      }
+      const T factor = basis_ij[i] * basis_ik[j];
+      if (EFLAG) energy += factor * sum;
+      dij += dnbasis_ij[i] * basis_ik[j] * sum;
+      dik += basis_ij[i] * dnbasis_ik[j] * sum;
+      djk += factor * dsum;
     }
   }
 
-  // Calculate forces
+  if (EFLAG) ret_val[0] = energy;
+  ret_val[1] = dij;
+  ret_val[2] = dik;
+  ret_val[3] = djk;
+}
 
-  double dnbasis_ij[4];
-  dnbasis_ij[0] = dnbsplines_ij[iknot_ij].eval2(rsq_ij, value_rij);
-  dnbasis_ij[1] = dnbsplines_ij[iknot_ij + 1].eval1(rsq_ij, value_rij);
-  dnbasis_ij[2] = dnbsplines_ij[iknot_ij + 2].eval0(rsq_ij, value_rij);
-  dnbasis_ij[3] = 0;
+// Size of the slab used by contract_ij() and eval_slab()
+int uf3_triplet_bspline::slab_size() const
+{
+  if (repr == REPR_TRICUBIC) return 32 * table_ik.nint * table_jk.nint;
+  return 2 * dim_ik * dim_jk;
+}
 
-  double dnbasis_ik[4];
-  dnbasis_ik[0] = dnbsplines_ik[iknot_ik].eval2(rsq_ik, value_rik);
-  dnbasis_ik[1] = dnbsplines_ik[iknot_ik + 1].eval1(rsq_ik, value_rik);
-  dnbasis_ik[2] = dnbsplines_ik[iknot_ik + 2].eval0(rsq_ik, value_rik);
-  dnbasis_ik[3] = 0;
+// Contract the tensor with the ij bases from bases_ij(). For the B-spline the slab
+// holds the dim_ik x dim_jk sums over ij of the coefficients times the bases
+// followed by the same sums with the derivatives of the bases. For the
+// tricubic it holds per ik x jk cell the 16 coefficients of the bicubic left
+// after the Horner scheme along ij, followed by those of its derivative.
+void uf3_triplet_bspline::contract_ij(const uf3_axis_bases &ij, double *slab) const
+{
+  if (store == STORE_INT16)
+    contract_ij_kernel<double, int16_t>(ij, slab);
+  else if (store == STORE_FLOAT)
+    contract_ij_kernel<double, float>(ij, slab);
+  else
+    contract_ij_kernel<double, double>(ij, slab);
+}
 
-  double dnbasis_jk[4];
-  dnbasis_jk[0] = dnbsplines_jk[iknot_jk].eval2(rsq_jk, value_rjk);
-  dnbasis_jk[1] = dnbsplines_jk[iknot_jk + 1].eval1(rsq_jk, value_rjk);
-  dnbasis_jk[2] = dnbsplines_jk[iknot_jk + 2].eval0(rsq_jk, value_rjk);
-  dnbasis_jk[3] = 0;
+void uf3_triplet_bspline::contract_ij(const uf3_axis_bases &ij, float *slab) const
+{
+  if (store == STORE_INT16)
+    contract_ij_kernel<float, int16_t>(ij, slab);
+  else
+    contract_ij_kernel<float, float>(ij, slab);
+}
 
-  for (int i = 0; i < 3; i++) {
-    const double dnbasis_iji = dnbasis_ij[i];
-    for (int j = 0; j < 4; j++) {
-      const double factor = dnbasis_iji * basis_ik[j];
-      const double* slice = &dncoeff_matrix_ij[iknot_ij + i][iknot_ik + j][iknot_jk];
-      double tmp[4];
-      tmp[0] = slice[0] * basis_jk[0];
-      tmp[1] = slice[1] * basis_jk[1];
-      tmp[2] = slice[2] * basis_jk[2];
-      tmp[3] = slice[3] * basis_jk[3];
-      double sum = tmp[0] + tmp[1] + tmp[2] + tmp[3];
-      ret_val[1] += factor * sum;
+template <typename T, typename S>
+void uf3_triplet_bspline::contract_ij_kernel(const uf3_axis_bases &ij, T *slab) const
+{
+  if (repr == REPR_TRICUBIC) {
+    const int a = ij.idx;
+    const T u = ij.u;
+    const int ncell = table_ik.nint * table_jk.nint;
+    const auto t = tricubic_reader<T, S>();
+    for (int bc = 0; bc < ncell; bc++) {
+      const size_t cell = (size_t) 64 * (ncell * a + bc);
+      T *g = slab + 32 * bc;
+      for (int qs = 0; qs < 16; qs++) {
+        T e = t[cell + 48 + qs], du = 0;
+        for (int p = 2; p >= 0; p--) {
+          du = du * u + e;
+          e = e * u + t[cell + 16 * p + qs];
+        }
+        g[qs] = e;
+        g[16 + qs] = du;
+      }
     }
+    return;
   }
 
-  for (int i = 0; i < 4; i++) {
-    const double basis_iji = basis_ij[i];
-    for (int j = 0; j < 3; j++) {
-      const double factor = basis_iji * dnbasis_ik[j];
-      const double* slice = &dncoeff_matrix_ik[iknot_ij + i][iknot_ik + j][iknot_jk];
-      double tmp[4];
-      tmp[0] = slice[0] * basis_jk[0];
-      tmp[1] = slice[1] * basis_jk[1];
-      tmp[2] = slice[2] * basis_jk[2];
-      tmp[3] = slice[3] * basis_jk[3];
-      double sum = tmp[0] + tmp[1] + tmp[2] + tmp[3];
-      ret_val[2] += factor * sum;
-    }
+  T bij[4], dbij[4];
+  for (int m = 0; m < 4; m++) {
+    bij[m] = ij.b[m];
+    dbij[m] = ij.db[m];
   }
+  const int a = ij.idx;
+  const int n = dim_ik * dim_jk;
+  const uf3_tensor_reader<T, S> c = coeff_reader<T, S>();
+  T *s = slab;
+  T *ds = slab + n;
+  for (int m = 0; m < 2 * n; m++) slab[m] = 0;
 
   for (int i = 0; i < 4; i++) {
-    const double basis_iji = basis_ij[i];
-    for (int j = 0; j < 4; j++) {
-      const double factor = basis_iji * basis_ik[j];
-      const double* slice = &dncoeff_matrix_jk[iknot_ij + i][iknot_ik + j][iknot_jk];
-      double tmp[3];
-      tmp[0] = slice[0] * dnbasis_jk[0];
-      tmp[1] = slice[1] * dnbasis_jk[1];
-      tmp[2] = slice[2] * dnbasis_jk[2];
-      double sum = tmp[0] + tmp[1] + tmp[2];
-      ret_val[3] += factor * sum;
+    for (int j = 0; j < dim_ik; j++) {
+      const int row = offset_ij[a + i] + offset_ik[j];
+      T *srow = s + j * dim_jk;
+      T *dsrow = ds + j * dim_jk;
+      for (int k = 0; k < dim_jk; k++) {
+        const T ck = c[row + offset_jk[k]];
+        srow[k] += bij[i] * ck;
+        dsrow[k] += dbij[i] * ck;
+      }
     }
   }
+}
 
-  return ret_val;
+// Energy and derivatives from a slab built by contract_ij() and the ik axis
+// from bases_ik(), ret_val as in eval()
+void uf3_triplet_bspline::eval_slab(const double *slab, const uf3_axis_bases &ik,
+                                    double value_rjk, double *ret_val) const
+{
+  if (knot_spacing_type == 0)
+    eval_slab_kernel<0>(slab, ik, value_rjk, ret_val);
+  else
+    eval_slab_kernel<1>(slab, ik, value_rjk, ret_val);
 }
 
-// Find starting knot for spline evaluation
+void uf3_triplet_bspline::eval_slab(const float *slab, const uf3_axis_bases &ik,
+                                    double value_rjk, double *ret_val) const
+{
+  if (knot_spacing_type == 0)
+    eval_slab_kernel<0>(slab, ik, value_rjk, ret_val);
+  else
+    eval_slab_kernel<1>(slab, ik, value_rjk, ret_val);
+}
 
-int uf3_triplet_bspline::starting_knot(const std::vector<double> knot_vect, int knot_vect_size,
-                                       double r)
+template <int SPACING, typename T>
+void uf3_triplet_bspline::eval_slab_kernel(const T *slab, const uf3_axis_bases &ik,
+                                           double value_rjk, double *ret_val) const
 {
-  if (knot_vect.front() <= r && r < knot_vect.back()) {
-    for (int i = 3; i < knot_vect_size - 1; i++) {
-      if (knot_vect[i] <= r && r < knot_vect[i + 1]) return i;
+  if (repr == REPR_TRICUBIC) {
+    const int b = ik.idx;
+    const int c = table_jk.interval<SPACING>(value_rjk);
+    const T v = ik.u;
+    const T w = value_rjk - table_jk.tlow[c];
+    const T *g = slab + 32 * (b * table_jk.nint + c);
+
+    T e = 0, du = 0, dv = 0, dw = 0;
+    for (int q = 3; q >= 0; q--) {
+      const T *gs = g + 4 * q;
+      const T *dgs = g + 16 + 4 * q;
+      const T f = ((gs[3] * w + gs[2]) * w + gs[1]) * w + gs[0];
+      const T fw = (3 * gs[3] * w + 2 * gs[2]) * w + gs[1];
+      const T fu = ((dgs[3] * w + dgs[2]) * w + dgs[1]) * w + dgs[0];
+      dv = dv * v + e;
+      e = e * v + f;
+      dw = dw * v + fw;
+      du = du * v + fu;
     }
+    ret_val[0] = e;
+    ret_val[1] = du;
+    ret_val[2] = dv;
+    ret_val[3] = dw;
+    return;
+  }
+
+  T bik[4], dbik[4], bjk[4], dbjk[4];
+  for (int m = 0; m < 4; m++) {
+    bik[m] = ik.b[m];
+    dbik[m] = ik.db[m];
+  }
+  const int b = ik.idx;
+  const int c = table_jk.eval_bases<SPACING>(value_rjk, bjk, dbjk);
+  const T *s = slab + b * dim_jk + c;
+  const T *ds = s + dim_ik * dim_jk;
+
+  T energy = 0, dij = 0, dik = 0, djk = 0;
+  for (int j = 0; j < 4; j++) {
+    const T *srow = s + j * dim_jk;
+    const T *dsrow = ds + j * dim_jk;
+    T sum = 0, dsum = 0, dijsum = 0;
+    for (int k = 0; k < 4; k++) {
+      sum += srow[k] * bjk[k];
+      dsum += srow[k] * dbjk[k];
+      dijsum += dsrow[k] * bjk[k];
+    }
+    energy += bik[j] * sum;
+    dik += dbik[j] * sum;
+    djk += bik[j] * dsum;
+    dij += bik[j] * dijsum;
+  }
+  ret_val[0] = energy;
+  ret_val[1] = dij;
+  ret_val[2] = dik;
+  ret_val[3] = djk;
+}
+
+// Evaluate a triplet of a loop over k at fixed rij with at most nleft
+// triplets to go, including this one. The ij and ik axes come from
+// bases_ij() and bases_ik(). slab_state has to be reset to 0 by the caller
+// whenever rij changes; on the first call the slab is built if nleft
+// reaches the break even point, otherwise eval() is used until the next
+// reset.
+void uf3_triplet_bspline::eval_factorized(const uf3_axis_bases &ij, const uf3_axis_bases &ik,
+                                          double value_rjk, int nleft, uf3_slab &slab,
+                                          int &slab_state, double *ret_val)
+{
+  if (slab_state == 0) {
+    if (nleft >= slab_min) {
+      if (prec == PREC_MIXED) {
+        if ((int) slab.f.size() < slab_size()) slab.f.resize(slab_size());
+        contract_ij(ij, slab.f.data());
+      } else {
+        if ((int) slab.d.size() < slab_size()) slab.d.resize(slab_size());
+        contract_ij(ij, slab.d.data());
+      }
+      slab_state = 1;
+    } else
+      slab_state = 2;
   }
 
-  return 0;
+  if (slab_state == 1) {
+    if (prec == PREC_MIXED)
+      eval_slab(slab.f.data(), ik, value_rjk, ret_val);
+    else
+      eval_slab(slab.d.data(), ik, value_rjk, ret_val);
+  } else
+    eval(ij, ik, value_rjk, ret_val);
+}
+
+// Evaluate n triplets at once. The derivatives with respect to rij, rik and
+// rjk are written to dedrij[], dedrik[] and dedrjk[], the energies to e[]
+// unless e is a nullptr. The loop over n runs on the per interval cubics of
+// the bases; energy and derivatives share one pass over the coefficients.
+void uf3_triplet_bspline::eval_batch(const double *rij, const double *rik, const double *rjk,
+                                     int n, double *e, double *dedrij, double *dedrik,
+                                     double *dedrjk)
+{
+  if (knot_spacing_type == 0)
+    eval_batch_kernel<0>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+  else
+    eval_batch_kernel<1>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
 }
 
-int uf3_triplet_bspline::get_starting_index_uniform(const std::vector<double> knot_vect, int knot_vect_size,
-                                                    double r, double knot_spacing)
+template <int SPACING>
+void uf3_triplet_bspline::eval_batch_kernel(const double *rij, const double *rik,
+                                            const double *rjk, int n, double *e, double *dedrij,
+                                            double *dedrik, double *dedrjk)
 {
-  return 3+(int)((r-knot_vect[0])/knot_spacing);
+  if (prec == PREC_MIXED) {
+    if (store == STORE_INT16)
+      eval_batch_kernel<SPACING, float, int16_t>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+    else
+      eval_batch_kernel<SPACING, float, float>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+  } else {
+    if (store == STORE_INT16)
+      eval_batch_kernel<SPACING, double, int16_t>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+    else if (store == STORE_FLOAT)
+      eval_batch_kernel<SPACING, double, float>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+    else
+      eval_batch_kernel<SPACING, double, double>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+  }
 }
 
-int uf3_triplet_bspline::get_starting_index_nonuniform(const std::vector<double> knot_vect, int knot_vect_size,
-                                                       double r, double knot_spacing)
+template <int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_batch_kernel(const double *rij, const double *rik,
+                                            const double *rjk, int n, double *e, double *dedrij,
+                                            double *dedrik, double *dedrjk)
 {
-  if (knot_vect.front() <= r && r < knot_vect.back()) {
-    //Determine the interval for value_rij
-    for (int i = 3; i < knot_vect_size - 1; ++i) {
-      if (knot_vect[i] <= r && r < knot_vect[i + 1]) {
-        return i;
+  if (repr == REPR_TRICUBIC) {
+    if (e)
+      eval_batch_tricubic<1, SPACING, T, S>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+    else
+      eval_batch_tricubic<0, SPACING, T, S>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+  } else {
+    if (e)
+      eval_batch_spline<1, SPACING, T, S>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+    else
+      eval_batch_spline<0, SPACING, T, S>(rij, rik, rjk, n, e, dedrij, dedrik, dedrjk);
+  }
+}
+
+template <int EFLAG, int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_batch_tricubic(const double *rij, const double *rik,
+                                              const double *rjk, int n, double *e, double *dedrij,
+                                              double *dedrik, double *dedrjk)
+{
+  UF3_SIMD
+  for (int m = 0; m < n; m++) {
+    double ret_val[4];
+    uf3_axis_bases ij, ik;
+    table_ij.locate<SPACING>(rij[m], ij);
+    table_ik.locate<SPACING>(rik[m], ik);
+    eval_tricubic<EFLAG, SPACING, T, S>(ij, ik, rjk[m], ret_val);
+    if (EFLAG) e[m] = ret_val[0];
+    dedrij[m] = ret_val[1];
+    dedrik[m] = ret_val[2];
+    dedrjk[m] = ret_val[3];
+  }
+}
+
+template <int EFLAG, int SPACING, typename T, typename S>
+void uf3_triplet_bspline::eval_batch_spline(const double *rij, const double *rik,
+                                            const double *rjk, int n, double *e, double *dedrij,
+                                            double *dedrik, double *dedrjk)
+{
+  const uf3_tensor_reader<T, S> c = coeff_reader<T, S>();
+  const int *_noalias const offij = offset_ij.data();
+  const int *_noalias const offik = offset_ik.data();
+  const int *_noalias const offjk = offset_jk.data();
+
+  UF3_SIMD
+  for (int m = 0; m < n; m++) {
+    T bij[4], dbij[4], bik[4], dbik[4], bjk[4], dbjk[4];
+    const int *oij = offij + table_ij.eval_bases<SPACING>(rij[m], bij, dbij);
+    const int *oik = offik + table_ik.eval_bases<SPACING>(rik[m], bik, dbik);
+    const int *ojk = offjk + table_jk.eval_bases<SPACING>(rjk[m], bjk, dbjk);
+
+    T energy = 0, dij = 0, dik = 0, djk = 0;
+    for (int i = 0; i < 4; i++) {
+      for (int j = 0; j < 4; j++) {
+        const int slice = oij[i] + oik[j];
+        T sum = 0, dsum = 0;
+        for (int k = 0; k < 4; k++) {
+          const T ck = c[slice + ojk[k]];
+          sum += ck * bjk[k];
+          dsum += ck * dbjk[k];
+        }
+        const T factor = bij[i] * bik[j];
+        if (EFLAG) energy += factor * sum;
+        dij += dbij[i] * bik[j] * sum;
+        dik += bij[i] * dbik[j] * sum;
+        djk += factor * dsum;
       }
     }
+    if (EFLAG) e[m] = energy;
+    dedrij[m] = dij;
+    dedrik[m] = dik;
+    dedrjk[m] = djk;
   }
 }
 
@@ -303,45 +722,19 @@ double uf3_triplet_bspline::memory_usage()
                                             //knot_vect_size_ik,
                                             //knot_vect_size_jk;
 
-  for (int i=0; i<coeff_matrix.size(); i++)
-    for (int j=0; j<coeff_matrix[i].size(); j++)
-      bytes += (double)coeff_matrix[i][j].size()*sizeof(double);
-
-
-  for (int i=0; i<dncoeff_matrix_ij.size(); i++)
-    for (int j=0; j<dncoeff_matrix_ij[i].size(); j++)
-      bytes += (double)dncoeff_matrix_ij[i][j].size()*sizeof(double);
-
-  for (int i=0; i<dncoeff_matrix_ik.size(); i++)
-    for (int j=0; j<dncoeff_matrix_ik[i].size(); j++)
-      bytes += (double)dncoeff_matrix_ik[i][j].size()*sizeof(double);
-
-  for (int i=0; i<dncoeff_matrix_jk.size(); i++)
-    for (int j=0; j<dncoeff_matrix_jk[i].size(); j++)
-      bytes += (double)dncoeff_matrix_jk[i][j].size()*sizeof(double);
-
-  bytes += (double)knot_matrix[0].size()*sizeof(double);
-  bytes += (double)knot_matrix[1].size()*sizeof(double);
-  bytes += (double)knot_matrix[2].size()*sizeof(double);
-
-  for (int i=0; i < bsplines_ij.size(); i++)
-    bytes += (double)bsplines_ij[i].memory_usage();
-
-  for (int i=0; i < bsplines_ik.size(); i++)
-    bytes += (double)bsplines_ik[i].memory_usage();
-
-  for (int i=0; i < bsplines_jk.size(); i++)
-    bytes += (double)bsplines_jk[i].memory_usage();
-
-  for (int i=0; i < dnbsplines_ij.size(); i++)
-    bytes += (double)dnbsplines_ij[i].memory_usage();
+  bytes += (double)7*sizeof(int);          //layout, repr, prec, store, dim_ij, dim_ik, dim_jk
+  bytes += (double)(offset_ij.size() + offset_ik.size() + offset_jk.size())*sizeof(int);
 
-  for (int i=0; i < dnbsplines_ik.size(); i++)
-    bytes += (double)dnbsplines_ik[i].memory_usage();
+  bytes += (double)table_ij.memory_usage();            //table_ij
+  bytes += (double)table_ik.memory_usage();            //table_ik
+  bytes += (double)table_jk.memory_usage();            //table_jk
 
-  for (int i=0; i < dnbsplines_jk.size(); i++)
-    bytes += (double)dnbsplines_jk[i].memory_usage();
+  bytes += (double)coeff.size()*sizeof(double);        //coeff
+  bytes += (double)tricubic.size()*sizeof(double);     //tricubic
+  bytes += (double)coeff_f.size()*sizeof(float);       //coeff_f
+  bytes += (double)tricubic_f.size()*sizeof(float);    //tricubic_f
+  bytes += (double)coeff_q.size()*sizeof(int16_t);     //coeff_q
+  bytes += (double)coeff_scale.size()*sizeof(float);   //coeff_scale
 
-  bytes += (double)4*sizeof(double);                        //ret_val
   return bytes;
 }
@@ -11,44 +11,195 @@
 
 #include "pointers.h"
 
-#include "uf3_bspline_basis2.h"
-#include "uf3_bspline_basis3.h"
+#include "uf3_aligned_allocator.h"
+#include "uf3_interval_table.h"
 #include "uf3_pair_bspline.h"
 
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
 #ifndef UF3_TRIPLET_BSPLINE_H
 #define UF3_TRIPLET_BSPLINE_H
 
 namespace LAMMPS_NS {
+
+// scratch of uf3_triplet_bspline::eval_factorized() owned by the caller,
+// the slab of the precision the spline is evaluated in
+struct uf3_slab {
+  std::vector<double> d;
+  std::vector<float> f;
+};
+
+// element access to a tensor stored as S and read as T. int16_t tensors
+// hold one power of two scale per 64 consecutive elements, which is exact
+// in T, so decompressing is a conversion and one multiplication.
+template <typename T, typename S> struct uf3_tensor_reader {
+  const S *data;
+  const float *scale;
+  inline T operator[](size_t off) const
+  {
+    if (std::is_integral<S>::value)
+      return static_cast<T>(data[off]) * static_cast<T>(scale[off >> 6]);
+    return static_cast<T>(data[off]);
+  }
+};
+
+// a 3-body coefficient tensor owned by the caller, element [ij][ik][jk] at
+// data[ij * stride[0] + ik * stride[1] + jk]. the strides allow reading a
+// tensor with its ij and ik axes swapped without copying it
+struct uf3_tensor_view {
+  const double *data;
+  int dim[3];    // ij, ik, jk
+  size_t stride[2];
+  inline double operator()(int ij, int ik, int jk) const
+  {
+    return data[ij * stride[0] + ik * stride[1] + jk];
+  }
+};
+
 class uf3_triplet_bspline {
  private:
   LAMMPS *lmp;
   int knot_vect_size_ij, knot_vect_size_ik, knot_vect_size_jk;
-  std::vector<std::vector<std::vector<double>>> coeff_matrix, dncoeff_matrix_ij, dncoeff_matrix_ik,
-      dncoeff_matrix_jk;
-  std::vector<std::vector<double>> knot_matrix;
-  std::vector<uf3_bspline_basis3> bsplines_ij, bsplines_ik, bsplines_jk;
-  std::vector<uf3_bspline_basis2> dnbsplines_ij, dnbsplines_ik, dnbsplines_jk;
-  int get_starting_index_uniform(const std::vector<double>, int, double, double);
-  int get_starting_index_nonuniform(const std::vector<double>, int, double, double);
-  int (uf3_triplet_bspline::*get_starting_index)(const std::vector<double>, int, double, double);
-  //double knot_spacing_ij=0,knot_spacing_ik=0,knot_spacing_jk=0; 
-  //double _alignvar(, 8) ret_val[4]; // Force memory alignment on 8 byte boundaries
-  double ret_val[4];
-
-  int starting_knot(const std::vector<double>, int, double);
+  // coefficients as a flat 64-byte aligned tensor of shape dim_ij x dim_ik x
+  // dim_jk. element [i][j][k] is stored at offset_ij[i] + offset_ik[j] +
+  // offset_jk[k], which covers both layouts
+  int layout, dim_ij, dim_ik, dim_jk;
+  std::vector<int> offset_ij, offset_ik, offset_jk;
+  std::vector<double, uf3_aligned_allocator<double>> coeff;
+  void set_layout(int);
+
+  // the kernels are specialized on the knot spacing type (SPACING), the
+  // floating point type of the contractions (T) and the type the tensors
+  // are stored as (S), the public functions select them once per call and
+  // the *_kernel functions then pick the representation and layout
+  template <int EFLAG, int SPACING> void eval_kernel(double, double, double, double *);
+  template <int EFLAG, int SPACING>
+  void eval_kernel(const uf3_axis_bases &, const uf3_axis_bases &, double, double *);
+  template <int EFLAG, int SPACING, typename T, typename S>
+  void eval_kernel(const uf3_axis_bases &, const uf3_axis_bases &, double, double *);
+  template <int SPACING>
+  void eval_batch_kernel(const double *, const double *, const double *, int, double *, double *,
+                         double *, double *);
+  template <int SPACING, typename T, typename S>
+  void eval_batch_kernel(const double *, const double *, const double *, int, double *, double *,
+                         double *, double *);
+  template <typename T, typename S> void contract_ij_kernel(const uf3_axis_bases &, T *) const;
+  template <int SPACING, typename T>
+  void eval_slab_kernel(const T *, const uf3_axis_bases &, double, double *) const;
+  template <int SPACING>
+  void axis_bases(const uf3_interval_table &, double, uf3_axis_bases &) const;
+
+  template <int EFLAG, int LAYOUT, int SPACING, typename T, typename S>
+  void eval_spline(const uf3_axis_bases &, const uf3_axis_bases &, double, double *);
+  uf3_interval_table table_ij, table_ik, table_jk;
+  template <int EFLAG, int SPACING, typename T, typename S>
+  void eval_batch_spline(const double *, const double *, const double *, int, double *, double *,
+                         double *, double *);
+  // optional tricubic representation: 64 power basis coefficients per knot
+  // cell in (rij - tlow_ij, rik - tlow_ik, rjk - tlow_jk), cell (a,b,c) at
+  // 64 * ((a * nint_ik + b) * nint_jk + c), element [p][q][s] at 16*p+4*q+s
+  int repr;
+  std::vector<double, uf3_aligned_allocator<double>> tricubic;
+  void set_tricubic();
+  int slab_min;    // fewest triplets sharing rij for which contract_ij() pays off
+  template <int EFLAG, int SPACING, typename T, typename S>
+  void eval_tricubic(const uf3_axis_bases &, const uf3_axis_bases &, double, double *);
+  template <int EFLAG, int SPACING, typename T, typename S>
+  void eval_batch_tricubic(const double *, const double *, const double *, int, double *, double *,
+                           double *, double *);
+
+  // copies of the coefficients in the precision and storage format they
+  // are read in, see set_storage()
+  int prec, store;
+  std::vector<float, uf3_aligned_allocator<float>> coeff_f, tricubic_f;
+  std::vector<int16_t, uf3_aligned_allocator<int16_t>> coeff_q;
+  std::vector<float> coeff_scale;
+  void set_storage();
+  const double *coeff_data(double) const { return coeff.data(); }
+  const float *coeff_data(float) const { return coeff_f.data(); }
+  const int16_t *coeff_data(int16_t) const { return coeff_q.data(); }
+  const double *tricubic_data(double) const { return tricubic.data(); }
+  const float *tricubic_data(float) const { return tricubic_f.data(); }
+  template <typename T, typename S> uf3_tensor_reader<T, S> coeff_reader() const
+  {
+    return {coeff_data(S()), coeff_scale.data()};
+  }
+  // the tricubics are kept in single precision instead of integers
+  template <typename S>
+  using tricubic_store = typename std::conditional<std::is_integral<S>::value, float, S>::type;
+  template <typename T, typename S> uf3_tensor_reader<T, tricubic_store<S>> tricubic_reader() const
+  {
+    return {tricubic_data(tricubic_store<S>()), nullptr};
+  }
 
  public:
+  // LAYOUT_LINEAR: row major, rows along jk padded to a multiple of 8
+  // LAYOUT_BLOCKED: 4x4x4 tiles, each tile contiguous (512 bytes)
+  enum { LAYOUT_LINEAR, LAYOUT_BLOCKED };
+  // REPR_BSPLINE: contract the bases with the coefficient tensors per triplet
+  // REPR_TRICUBIC: one precomputed tricubic per knot cell, 64x the memory
+  enum { REPR_BSPLINE, REPR_TRICUBIC };
+  // PREC_DOUBLE: everything in double precision
+  // PREC_MIXED: the contractions with the coefficients and the jk bases in
+  // single precision, distances, intervals and the results in double
+  enum { PREC_DOUBLE, PREC_MIXED };
+  // STORE_DOUBLE: the coefficients are kept in double precision
+  // STORE_FLOAT: kept in single precision, half the memory
+  // STORE_INT16: kept as 16-bit integers with a scale per 64 elements,
+  // about a quarter of the memory, tricubics as with STORE_FLOAT. either
+  // is expanded to the precision of the contractions while it is read
+  enum { STORE_DOUBLE, STORE_FLOAT, STORE_INT16 };
+
   //Dummy Constructor
   uf3_triplet_bspline();
-  uf3_triplet_bspline(LAMMPS *ulmp, const std::vector<std::vector<double>> &uknot_matrix,
-                      const std::vector<std::vector<std::vector<double>>> &ucoeff_matrix,
-                      const int &uknot_spacing_type);
+  // the knots are ordered jk, ik, ij. the spline keeps its own copy of the
+  // coefficients in the chosen layout, ucoeff is only read here
+  uf3_triplet_bspline(LAMMPS *ulmp, const std::vector<double> &uknots_jk,
+                      const std::vector<double> &uknots_ik, const std::vector<double> &uknots_ij,
+                      const uf3_tensor_view &ucoeff, const int &uknot_spacing_type,
+                      int ulayout = LAYOUT_LINEAR,
+                      int urepr = REPR_BSPLINE, int uprec = PREC_DOUBLE,
+                      int ustore = STORE_DOUBLE);
   ~uf3_triplet_bspline();
   int knot_spacing_type;
   double knot_spacing_ij=0,knot_spacing_ik=0,knot_spacing_jk=0;
-  double *eval(double value_rij, double value_rik, double value_rjk);
+  void eval(double value_rij, double value_rik, double value_rjk, double *ret_val);
+  void eval_deriv(double value_rij, double value_rik, double value_rjk, double *ret_val);
+  void eval_batch(const double *rij, const double *rik, const double *rjk, int n, double *e,
+                  double *dedrij, double *dedrik, double *dedrjk);
+
+  // the ij and ik axes at a distance, for callers that reuse rij or rik in
+  // several triplets. eval() with them only evaluates the jk axis.
+  void bases_ij(double value_rij, uf3_axis_bases &ij) const;
+  void bases_ik(double value_rik, uf3_axis_bases &ik) const;
+  void eval(const uf3_axis_bases &ij, const uf3_axis_bases &ik, double value_rjk,
+            double *ret_val);
+
+  // factorized evaluation for several triplets sharing rij: contract_ij()
+  // sums the ij axis into a slab owned by the caller, eval_slab() then only
+  // contracts the 4x4 ik x jk block of the slab. eval_factorized() decides
+  // per rij whether building the slab is worth it for nleft triplets.
+  // the float slabs are for PREC_MIXED only.
+  int slab_size() const;
+  void contract_ij(const uf3_axis_bases &ij, double *slab) const;
+  void contract_ij(const uf3_axis_bases &ij, float *slab) const;
+  void eval_slab(const double *slab, const uf3_axis_bases &ik, double value_rjk,
+                 double *ret_val) const;
+  void eval_slab(const float *slab, const uf3_axis_bases &ik, double value_rjk,
+                 double *ret_val) const;
+  void eval_factorized(const uf3_axis_bases &ij, const uf3_axis_bases &ik, double value_rjk,
+                       int nleft, uf3_slab &slab, int &slab_state, double *ret_val);
+
+  int representation() const { return repr; }
+  int precision() const { return prec; }
+  int storage() const { return store; }
+  const double *get_tricubic() const { return tricubic.data(); }    // PREC_DOUBLE, STORE_DOUBLE only
+  int get_nint(int d) const
+  {
+    return (d == 0) ? table_jk.nint : ((d == 1) ? table_ik.nint : table_ij.nint);
+  }
 
   double memory_usage();
 };
@@ -0,0 +1,773 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida),
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#include "pair_uf3_intel.h"
+
+#include "uf3_bspline_basis3.h"
+#include "uf3_interval_table.h"
+#include "uf3_simd.h"
+
+#include "atom.h"
+#include "comm.h"
+#include "error.h"
+#include "force.h"
+#include "math_const.h"
+#include "memory.h"
+#include "neigh_list.h"
+#include "neighbor.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+namespace {
+
+// rows of the per neighbor buffers
+enum { DX, DY, DZ, RSQ, FPAIR, EPAIR, SDX, SDY, SDZ, SR, TE, TA1, TA2, TA3, NFBUF };
+enum { JIDX, JTYPE, INCUT, SJ, STYPE, TMASK, NIBUF };
+
+// raw pointers into a ForceConst, so the vectorized loops see plain arrays
+template <class flt_t> struct SplineTables {
+  const int *_noalias nint, *_noalias off, *_noalias nbucket, *_noalias boff, *_noalias bucket;
+  const flt_t *_noalias kstart, *_noalias inv_spacing;
+  const flt_t *_noalias tlow, *_noalias tnext, *_noalias basis, *_noalias coeff_2b;
+
+  SplineTables(const PairUF3Intel::ForceConst<flt_t> &fc) :
+      nint(fc.nint.data()), off(fc.off.data()), nbucket(fc.nbucket.data()),
+      boff(fc.boff.data()), bucket(fc.bucket.data()), kstart(fc.kstart.data()),
+      inv_spacing(fc.inv_spacing.data()), tlow(fc.tlow.data()), tnext(fc.tnext.data()),
+      basis(fc.basis.data()), coeff_2b(fc.coeff_2b.data())
+  {
+  }
+
+  // knot interval of axis ax containing r, counted from the first non-empty
+  // one. uniform knots use the spacing, non-uniform knots the bucket table of
+  // uf3_interval_table followed by two comparisons with the next knots.
+  inline int interval(const int ax, const flt_t r) const
+  {
+    int idx = static_cast<int>((r - kstart[ax]) * inv_spacing[ax]);
+    if (nbucket[ax]) {
+      idx = (idx < 0) ? 0 : idx;
+      idx = bucket[boff[ax] + ((idx > nbucket[ax] - 1) ? nbucket[ax] - 1 : idx)];
+      idx += (r >= tnext[off[ax] + idx]) ? 1 : 0;
+      idx += (r >= tnext[off[ax] + idx]) ? 1 : 0;
+    }
+    idx = (idx < 0) ? 0 : idx;
+    return (idx > nint[ax] - 1) ? nint[ax] - 1 : idx;
+  }
+
+  // energy and derivative of the 2-body spline of axis ax
+  inline void pair(const int ax, const flt_t r, flt_t &e, flt_t &dedr) const
+  {
+    const int iv = off[ax] + interval(ax, r);
+    const flt_t u = r - tlow[iv];
+    const flt_t *_noalias c = coeff_2b + 4 * iv;
+    e = ((c[3] * u + c[2]) * u + c[1]) * u + c[0];
+    dedr = ((flt_t) 3 * c[3] * u + (flt_t) 2 * c[2]) * u + c[1];
+  }
+
+  // values and derivatives of the 4 bases of axis ax that are non-zero at r,
+  // returns the index of the first one
+  inline int bases(const int ax, const flt_t r, flt_t *b, flt_t *db) const
+  {
+    const int idx = interval(ax, r);
+    const int iv = off[ax] + idx;
+    const flt_t u = r - tlow[iv];
+    const flt_t *_noalias c = basis + 16 * iv;
+    for (int m = 0; m < 4; m++) {
+      b[m] = ((c[4 * m + 3] * u + c[4 * m + 2]) * u + c[4 * m + 1]) * u + c[4 * m];
+      db[m] = ((flt_t) 3 * c[4 * m + 3] * u + (flt_t) 2 * c[4 * m + 2]) * u + c[4 * m + 1];
+    }
+    return idx;
+  }
+};
+
+}    // namespace
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3Intel::PairUF3Intel(LAMMPS *lmp) : PairUF3(lmp)
+{
+  packed = packed_precision = 0;
+  keep_pot_data = 1;       // released once the tables are packed, see init_one()
+  build_3b_splines = 0;    // the 3-body term is evaluated from the packed tables only
+  fbuf = nullptr;
+  ibuf = nullptr;
+  maxbuf = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3Intel::~PairUF3Intel()
+{
+  if (copymode) return;
+  memory->destroy(fbuf);
+  memory->destroy(ibuf);
+}
+
+/* ----------------------------------------------------------------------
+   global settings, the arguments of uf3. the precision keyword selects
+   the packed tables, mixed (float splines, double accumulation) unless
+   "precision double" is given. the keywords tuning the 3-body splines of
+   uf3 have no effect on the packed tables
+------------------------------------------------------------------------- */
+
+void PairUF3Intel::settings(int narg, char **arg)
+{
+  PairUF3::settings(narg, arg);
+
+  int precision_set = 0;
+  for (int iarg = 2; iarg < narg; iarg++) {
+    if (strcmp(arg[iarg], "precision") == 0) precision_set = 1;
+    if (((strcmp(arg[iarg], "layout") == 0) || (strcmp(arg[iarg], "compress") == 0) ||
+         (strcmp(arg[iarg], "persist") == 0)) && (comm->me == 0))
+      error->warning(FLERR, "UF3: pair_style uf3/intel ignores the {} keyword", arg[iarg]);
+  }
+  if (!precision_set) precision_3b = uf3_triplet_bspline::PREC_MIXED;
+
+  if (packed && (precision_3b != packed_precision))
+    error->all(FLERR, "UF3: pair_style uf3/intel precision cannot be changed after the first run");
+}
+
+/* ----------------------------------------------------------------------
+   the 3-body term is always evaluated from the packed tables, a trailing
+   tricubic keyword is accepted but has no effect
+------------------------------------------------------------------------- */
+
+void PairUF3Intel::coeff(int narg, char **arg)
+{
+  if ((narg == 6) && utils::strmatch(arg[0], "3b") && (strcmp(arg[5], "tricubic") == 0) &&
+      (comm->me == 0))
+    error->warning(FLERR, "UF3: pair_style uf3/intel ignores the tricubic keyword of pair_coeff");
+
+  PairUF3::coeff(narg, arg);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairUF3Intel::init_style()
+{
+  if (force->newton_pair == 0) error->all(FLERR, "UF3: Pair style requires newton pair on");
+
+  // the vectorized kernel walks all neighbors of i once for both the pairs
+  // and the triplets, so it keeps the single full list
+  neighbor->add_request(this, NeighConst::REQ_FULL);
+}
+
+/* ----------------------------------------------------------------------
+   the tables are packed right after the splines are set up, at the first
+   run, after which the potential files are no longer needed
+------------------------------------------------------------------------- */
+
+double PairUF3Intel::init_one(int i, int j)
+{
+  const int pack = !bsplines_created;
+  const double cutone = PairUF3::init_one(i, j);
+
+  if (pack) {
+    if (precision_3b == uf3_triplet_bspline::PREC_DOUBLE)
+      pack_force_const(force_const_double);
+    else
+      pack_force_const(force_const_single);
+    packed = 1;
+    packed_precision = precision_3b;
+    release_pot_data();
+  }
+  return cutone;
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairUF3Intel::compute(int eflag, int vflag)
+{
+  ev_init(eflag, vflag);
+
+  if (precision_3b == uf3_triplet_bspline::PREC_DOUBLE)
+    compute<double, double>(force_const_double);
+  else
+    compute<float, double>(force_const_single);
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <class flt_t, class acc_t> void PairUF3Intel::compute(ForceConst<flt_t> &fc)
+{
+  if (evflag) {
+    if (eflag_either) eval<flt_t, acc_t, 1, 1>(fc);
+    else eval<flt_t, acc_t, 1, 0>(fc);
+  } else eval<flt_t, acc_t, 0, 0>(fc);
+}
+
+/* ----------------------------------------------------------------------
+   per atom i the neighbors are first unpacked into SoA buffers. the
+   2-body, short list and triplet loops then run over these buffers with
+   the spline evaluation and the 3-body contraction fully inlined, so
+   they vectorize across neighbors. energy/virial tallies, which need
+   scalar per-pair calls, are done in separate loops over the buffers.
+------------------------------------------------------------------------- */
+
+template <class flt_t, class acc_t, int EVFLAG, int EFLAG>
+void PairUF3Intel::eval(ForceConst<flt_t> &fc)
+{
+  const SplineTables<flt_t> st(fc);
+
+  const dbl3_t *_noalias const x = (dbl3_t *) atom->x[0];
+  dbl3_t *_noalias const f = (dbl3_t *) atom->f[0];
+  const int *_noalias const type = atom->type;
+  const int nlocal = atom->nlocal;
+  const int newton_pair = force->newton_pair;
+  const int cvflag = vflag_either && cvflag_atom;
+
+  const int ntp = num_of_elements + 1;
+  const int *_noalias const axis_2b = fc.axis_2b.data();
+  const flt_t *_noalias const cutsq_2b = fc.cutsq_2b.data();
+  const flt_t *_noalias const cut_list = fc.cut_list.data();
+  const flt_t *_noalias const cut_ij = fc.cut_ij.data();
+  const flt_t *_noalias const cut_ik = fc.cut_ik.data();
+  const flt_t *_noalias const cut_jk = fc.cut_jk.data();
+  const flt_t *_noalias const min_ij = fc.min_ij.data();
+  const flt_t *_noalias const min_ik = fc.min_ik.data();
+  const flt_t *_noalias const min_jk = fc.min_jk.data();
+  const int *_noalias const axis_3b = fc.axis_3b.data();
+  const int *_noalias const off_3b = fc.off_3b.data();
+  const int *_noalias const stride1_3b = fc.stride1_3b.data();
+  const int *_noalias const stride2_3b = fc.stride2_3b.data();
+  const flt_t *_noalias const coeff_3b = fc.coeff_3b.data();
+
+  const int inum = list->inum;
+  const int *const ilist = list->ilist;
+  const int *const numneigh = list->numneigh;
+  int **const firstneigh = list->firstneigh;
+
+  for (int ii = 0; ii < inum; ii++) {
+    const int i = ilist[ii];
+    const int itype = type[i];
+    const double xtmp = x[i].x;
+    const double ytmp = x[i].y;
+    const double ztmp = x[i].z;
+    const int *const jlist = firstneigh[i];
+    const int jnum = numneigh[i];
+
+    if (jnum > maxbuf) grow_buffers(jnum);
+    flt_t *_noalias const dx = (flt_t *) fbuf[DX];
+    flt_t *_noalias const dy = (flt_t *) fbuf[DY];
+    flt_t *_noalias const dz = (flt_t *) fbuf[DZ];
+    flt_t *_noalias const rsqb = (flt_t *) fbuf[RSQ];
+    flt_t *_noalias const fpair = (flt_t *) fbuf[FPAIR];
+    flt_t *_noalias const epair = (flt_t *) fbuf[EPAIR];
+    int *_noalias const jidx = ibuf[JIDX];
+    int *_noalias const jtypeb = ibuf[JTYPE];
+    int *_noalias const incut = ibuf[INCUT];
+
+    const int ip = itype * ntp;
+    acc_t fxtmp = 0, fytmp = 0, fztmp = 0;
+
+    // 2-body: gather positions and evaluate the pair splines
+
+    UF3_SIMD
+    for (int jj = 0; jj < jnum; jj++) {
+      const int j = jlist[jj] & NEIGHMASK;
+      const int jtype = type[j];
+      const flt_t delx = xtmp - x[j].x;
+      const flt_t dely = ytmp - x[j].y;
+      const flt_t delz = ztmp - x[j].z;
+      const flt_t rsq = delx * delx + dely * dely + delz * delz;
+      const int p = ip + jtype;
+
+      flt_t fp = 0, ep = 0;
+      const int in = (rsq < cutsq_2b[p]) ? 1 : 0;
+      if (in) {
+        const flt_t r = sqrt(rsq);
+        flt_t dedr;
+        st.pair(axis_2b[p], r, ep, dedr);
+        fp = -dedr / r;
+      }
+
+      jidx[jj] = j;
+      jtypeb[jj] = jtype;
+      incut[jj] = in;
+      dx[jj] = delx;
+      dy[jj] = dely;
+      dz[jj] = delz;
+      rsqb[jj] = rsq;
+      fpair[jj] = fp;
+      if (EFLAG) epair[jj] = ep;
+    }
+
+    UF3_SIMD_SUM(fxtmp, fytmp, fztmp)
+    for (int jj = 0; jj < jnum; jj++) {
+      const flt_t fx = dx[jj] * fpair[jj];
+      const flt_t fy = dy[jj] * fpair[jj];
+      const flt_t fz = dz[jj] * fpair[jj];
+      const int j = jidx[jj];
+      fxtmp += fx;
+      fytmp += fy;
+      fztmp += fz;
+      f[j].x -= fx;
+      f[j].y -= fy;
+      f[j].z -= fz;
+    }
+
+    if (EVFLAG) {
+      for (int jj = 0; jj < jnum; jj++) {
+        if (!incut[jj]) continue;
+        const int j = jidx[jj];
+        const double delx = dx[jj];
+        const double dely = dy[jj];
+        const double delz = dz[jj];
+        const double fx = delx * fpair[jj];
+        const double fy = dely * fpair[jj];
+        const double fz = delz * fpair[jj];
+        const double evdwl = EFLAG ? epair[jj] : 0.0;
+
+        ev_tally_xyz(i, j, nlocal, newton_pair, evdwl, 0.0, fx, fy, fz, delx, dely, delz);
+
+        // Centroid Stress
+        if (cvflag) {
+          double v[6];
+
+          v[0] = delx * fx;
+          v[1] = dely * fy;
+          v[2] = delz * fz;
+          v[3] = delx * fy;
+          v[4] = delx * fz;
+          v[5] = dely * fz;
+
+          cvatom[i][0] += 0.5 * v[0];
+          cvatom[i][1] += 0.5 * v[1];
+          cvatom[i][2] += 0.5 * v[2];
+          cvatom[i][3] += 0.5 * v[3];
+          cvatom[i][4] += 0.5 * v[4];
+          cvatom[i][5] += 0.5 * v[5];
+          cvatom[i][6] += 0.5 * v[3];
+          cvatom[i][7] += 0.5 * v[4];
+          cvatom[i][8] += 0.5 * v[5];
+
+          cvatom[j][0] += 0.5 * v[0];
+          cvatom[j][1] += 0.5 * v[1];
+          cvatom[j][2] += 0.5 * v[2];
+          cvatom[j][3] += 0.5 * v[3];
+          cvatom[j][4] += 0.5 * v[4];
+          cvatom[j][5] += 0.5 * v[5];
+          cvatom[j][6] += 0.5 * v[3];
+          cvatom[j][7] += 0.5 * v[4];
+          cvatom[j][8] += 0.5 * v[5];
+        }
+      }
+    }
+
+    if (!pot_3b) {
+      f[i].x += fxtmp;
+      f[i].y += fytmp;
+      f[i].z += fztmp;
+      continue;
+    }
+
+    // 3-body: compact the neighbors within the 3-body cutoff,
+    // with del_rji = xj - xi as in the reference kernel
+
+    flt_t *_noalias const sdx = (flt_t *) fbuf[SDX];
+    flt_t *_noalias const sdy = (flt_t *) fbuf[SDY];
+    flt_t *_noalias const sdz = (flt_t *) fbuf[SDZ];
+    flt_t *_noalias const sr = (flt_t *) fbuf[SR];
+    flt_t *_noalias const te = (flt_t *) fbuf[TE];
+    flt_t *_noalias const ta1 = (flt_t *) fbuf[TA1];
+    flt_t *_noalias const ta2 = (flt_t *) fbuf[TA2];
+    flt_t *_noalias const ta3 = (flt_t *) fbuf[TA3];
+    int *_noalias const sj = ibuf[SJ];
+    int *_noalias const stype = ibuf[STYPE];
+    int *_noalias const tmask = ibuf[TMASK];
+
+    int numshort = 0;
+    for (int jj = 0; jj < jnum; jj++) {
+      if (!incut[jj]) continue;
+      const flt_t r = sqrt(rsqb[jj]);
+      if (r <= cut_list[ip + jtypeb[jj]]) {
+        sj[numshort] = jidx[jj];
+        stype[numshort] = jtypeb[jj];
+        sdx[numshort] = -dx[jj];
+        sdy[numshort] = -dy[jj];
+        sdz[numshort] = -dz[jj];
+        sr[numshort] = r;
+        numshort++;
+      }
+    }
+
+    for (int jj = 0; jj < numshort - 1; jj++) {
+      const int j = sj[jj];
+      const flt_t djx = sdx[jj];
+      const flt_t djy = sdy[jj];
+      const flt_t djz = sdz[jj];
+      const flt_t rij = sr[jj];
+      const int tbase = (ip + stype[jj]) * ntp;
+
+      UF3_SIMD
+      for (int kk = jj + 1; kk < numshort; kk++) {
+        const int t = tbase + stype[kk];
+        const flt_t rik = sr[kk];
+        const flt_t dkjx = sdx[kk] - djx;
+        const flt_t dkjy = sdy[kk] - djy;
+        const flt_t dkjz = sdz[kk] - djz;
+        const flt_t rjk = sqrt(dkjx * dkjx + dkjy * dkjy + dkjz * dkjz);
+
+        flt_t e = 0, a1 = 0, a2 = 0, a3 = 0;
+        const int in = (rij <= cut_ij[t]) && (rik <= cut_ik[t]) && (rjk <= cut_jk[t]) &&
+            (rij >= min_ij[t]) && (rik >= min_ik[t]) && (rjk >= min_jk[t]);
+        if (in) {
+          // jtype > ktype uses the axes of i-k-j, its ij axis is ax + 1
+          const int ax = axis_3b[t];
+          const int sw = (stype[jj] > stype[kk]) ? 1 : 0;
+          flt_t bij[4], dbij[4], bik[4], dbik[4], bjk[4], dbjk[4];
+          const int iij = st.bases(ax + sw, rij, bij, dbij);
+          const int iik = st.bases(ax + 1 - sw, rik, bik, dbik);
+          const int ijk = st.bases(ax + 2, rjk, bjk, dbjk);
+
+          const int s1 = stride1_3b[t];
+          const int s2 = stride2_3b[t];
+          const flt_t *_noalias c = coeff_3b + off_3b[t] + iij * s1 + iik * s2 + ijk;
+
+          // contract the 4x4x4 block once for the energy and all three
+          // derivatives, the jk sums are shared between them
+          flt_t ev = 0, dij = 0, dik = 0, djk = 0;
+          for (int a = 0; a < 4; a++) {
+            for (int b = 0; b < 4; b++) {
+              const flt_t *_noalias row = c + a * s1 + b * s2;
+              const flt_t sum =
+                  row[0] * bjk[0] + row[1] * bjk[1] + row[2] * bjk[2] + row[3] * bjk[3];
+              const flt_t dsum =
+                  row[0] * dbjk[0] + row[1] * dbjk[1] + row[2] * dbjk[2] + row[3] * dbjk[3];
+              const flt_t w = bij[a] * bik[b];
+              if (EFLAG) ev += w * sum;
+              dij += dbij[a] * bik[b] * sum;
+              dik += bij[a] * dbik[b] * sum;
+              djk += w * dsum;
+            }
+          }
+          e = ev;
+          a1 = dij / rij;
+          a2 = dik / rik;
+          a3 = djk / rjk;
+        }
+        tmask[kk] = in;
+        if (EFLAG) te[kk] = e;
+        ta1[kk] = a1;
+        ta2[kk] = a2;
+        ta3[kk] = a3;
+      }
+
+      acc_t fjx = 0, fjy = 0, fjz = 0;
+      UF3_SIMD_SUM(fxtmp, fytmp, fztmp, fjx, fjy, fjz)
+      for (int kk = jj + 1; kk < numshort; kk++) {
+        const flt_t dkjx = sdx[kk] - djx;
+        const flt_t dkjy = sdy[kk] - djy;
+        const flt_t dkjz = sdz[kk] - djz;
+        const flt_t fijx = ta1[kk] * djx;
+        const flt_t fijy = ta1[kk] * djy;
+        const flt_t fijz = ta1[kk] * djz;
+        const flt_t fikx = ta2[kk] * sdx[kk];
+        const flt_t fiky = ta2[kk] * sdy[kk];
+        const flt_t fikz = ta2[kk] * sdz[kk];
+        const flt_t fjkx = ta3[kk] * dkjx;
+        const flt_t fjky = ta3[kk] * dkjy;
+        const flt_t fjkz = ta3[kk] * dkjz;
+        const int k = sj[kk];
+
+        fxtmp += fijx + fikx;
+        fytmp += fijy + fiky;
+        fztmp += fijz + fikz;
+        fjx += fjkx - fijx;
+        fjy += fjky - fijy;
+        fjz += fjkz - fijz;
+        f[k].x -= fikx + fjkx;
+        f[k].y -= fiky + fjky;
+        f[k].z -= fikz + fjkz;
+      }
+      f[j].x += fjx;
+      f[j].y += fjy;
+      f[j].z += fjz;
+
+      if (EVFLAG) {
+        for (int kk = jj + 1; kk < numshort; kk++) {
+          if (!tmask[kk]) continue;
+          const int k = sj[kk];
+          double del_rji[3], del_rki[3], del_rkj[3];
+          double Fi[3], Fj[3], Fk[3];
+
+          del_rji[0] = djx;
+          del_rji[1] = djy;
+          del_rji[2] = djz;
+          del_rki[0] = sdx[kk];
+          del_rki[1] = sdy[kk];
+          del_rki[2] = sdz[kk];
+          for (int d = 0; d < 3; d++) {
+            del_rkj[d] = del_rki[d] - del_rji[d];
+            const double fij = ta1[kk] * del_rji[d];
+            const double fik = ta2[kk] * del_rki[d];
+            const double fjk = ta3[kk] * del_rkj[d];
+            Fi[d] = fij + fik;
+            Fj[d] = fjk - fij;
+            Fk[d] = -fik - fjk;
+          }
+          const double evdwl = EFLAG ? te[kk] : 0.0;
+
+          ev_tally3(i, j, k, evdwl, 0, Fj, Fk, del_rji, del_rki);
+
+          // Centroid stress 3-body term
+          if (cvflag) {
+            double ric[3];
+            ric[0] = THIRD * (-del_rji[0] - del_rki[0]);
+            ric[1] = THIRD * (-del_rji[1] - del_rki[1]);
+            ric[2] = THIRD * (-del_rji[2] - del_rki[2]);
+
+            cvatom[i][0] += ric[0] * Fi[0];
+            cvatom[i][1] += ric[1] * Fi[1];
+            cvatom[i][2] += ric[2] * Fi[2];
+            cvatom[i][3] += ric[0] * Fi[1];
+            cvatom[i][4] += ric[0] * Fi[2];
+            cvatom[i][5] += ric[1] * Fi[2];
+            cvatom[i][6] += ric[1] * Fi[0];
+            cvatom[i][7] += ric[2] * Fi[0];
+            cvatom[i][8] += ric[2] * Fi[1];
+
+            double rjc[3];
+            rjc[0] = THIRD * (del_rji[0] - del_rkj[0]);
+            rjc[1] = THIRD * (del_rji[1] - del_rkj[1]);
+            rjc[2] = THIRD * (del_rji[2] - del_rkj[2]);
+
+            cvatom[j][0] += rjc[0] * Fj[0];
+            cvatom[j][1] += rjc[1] * Fj[1];
+            cvatom[j][2] += rjc[2] * Fj[2];
+            cvatom[j][3] += rjc[0] * Fj[1];
+            cvatom[j][4] += rjc[0] * Fj[2];
+            cvatom[j][5] += rjc[1] * Fj[2];
+            cvatom[j][6] += rjc[1] * Fj[0];
+            cvatom[j][7] += rjc[2] * Fj[0];
+            cvatom[j][8] += rjc[2] * Fj[1];
+
+            double rkc[3];
+            rkc[0] = THIRD * (del_rki[0] + del_rkj[0]);
+            rkc[1] = THIRD * (del_rki[1] + del_rkj[1]);
+            rkc[2] = THIRD * (del_rki[2] + del_rkj[2]);
+
+            cvatom[k][0] += rkc[0] * Fk[0];
+            cvatom[k][1] += rkc[1] * Fk[1];
+            cvatom[k][2] += rkc[2] * Fk[2];
+            cvatom[k][3] += rkc[0] * Fk[1];
+            cvatom[k][4] += rkc[0] * Fk[2];
+            cvatom[k][5] += rkc[1] * Fk[2];
+            cvatom[k][6] += rkc[1] * Fk[0];
+            cvatom[k][7] += rkc[2] * Fk[0];
+            cvatom[k][8] += rkc[2] * Fk[1];
+          }
+        }
+      }
+    }
+
+    f[i].x += fxtmp;
+    f[i].y += fytmp;
+    f[i].z += fztmp;
+  }
+}
+
+/* ----------------------------------------------------------------------
+   rows are padded to 64 bytes so every buffer starts aligned
+------------------------------------------------------------------------- */
+
+void PairUF3Intel::grow_buffers(int n)
+{
+  maxbuf = (n + 15) & ~15;
+  memory->destroy(fbuf);
+  memory->destroy(ibuf);
+  memory->create(fbuf, NFBUF, maxbuf, "pair:fbuf");
+  memory->create(ibuf, NIBUF, maxbuf, "pair:ibuf");
+}
+
+/* ----------------------------------------------------------------------
+   append the knot interval lookup and the per interval cubics of one
+   spline axis, coeff = nullptr packs the bare 3-body bases
+------------------------------------------------------------------------- */
+
+template <class flt_t>
+int PairUF3Intel::pack_axis(ForceConst<flt_t> &fc, const std::vector<double> &knots,
+                            const std::vector<double> *coeff, int spacing_type)
+{
+  const int ax = fc.nint.size();
+  const int n = knots.size();
+  const int nint = n - 7;
+  if (nint < 1) error->all(FLERR, "UF3: uf3/intel requires at least 8 knots per spline");
+
+  fc.nint.push_back(nint);
+  fc.off.push_back(fc.tlow.size());
+  double kstart = knots[3];
+  double inv_spacing = 1.0 / (knots[4] - knots[3]);
+  std::vector<int> bucket;
+  if (spacing_type == 1 &&
+      !uf3_interval_table::make_buckets(knots, kstart, inv_spacing, bucket))
+    error->all(FLERR, "UF3: uf3/intel cannot build the knot lookup of a non-uniform spline");
+  fc.kstart.push_back(kstart);
+  fc.inv_spacing.push_back(inv_spacing);
+  fc.nbucket.push_back(bucket.size());
+  fc.boff.push_back(fc.bucket.size());
+  fc.bucket.insert(fc.bucket.end(), bucket.begin(), bucket.end());
+
+  // interval s spans [knots[s], knots[s+1]), bases s-3..s are non-zero on
+  // it with their pieces 3..0. the cubics are re-expanded around knots[s]
+  // which also keeps them well conditioned in single precision.
+  for (int s = 3; s <= n - 5; s++) {
+    const double t = knots[s];
+    fc.tlow.push_back(t);
+    fc.tnext.push_back((s < n - 5) ? knots[s + 1] : std::numeric_limits<flt_t>::max());
+    for (int m = 0; m < 4; m++) {
+      const int l = s - 3 + m;
+      uf3_bspline_basis3 bspline(lmp, &knots[l], coeff ? (*coeff)[l] : 1.0);
+      const double *c = bspline.get_constants() + 4 * (3 - m);
+      fc.basis.push_back(c[0] + (c[1] + (c[2] + c[3] * t) * t) * t);
+      fc.basis.push_back(c[1] + (2 * c[2] + 3 * c[3] * t) * t);
+      fc.basis.push_back(c[2] + 3 * c[3] * t);
+      fc.basis.push_back(c[3]);
+    }
+  }
+  return ax;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <class flt_t> void PairUF3Intel::pack_force_const(ForceConst<flt_t> &fc)
+{
+  const int ntp = num_of_elements + 1;
+  fc = ForceConst<flt_t>();
+
+  // 2-body axes first, so their intervals are numbered before the 3-body ones
+
+  fc.axis_2b.assign(ntp * ntp, 0);
+  fc.cutsq_2b.assign(ntp * ntp, 0);
+  fc.cut_list.assign(ntp * ntp, 0);
+  for (int i = 1; i < ntp; i++) {
+    for (int j = i; j < ntp; j++) {
+      const int ax = pack_axis(fc, knots_2b(i, j), &coeff_2b(i, j), knot_spacing_type_2b[i][j]);
+      fc.axis_2b[i * ntp + j] = fc.axis_2b[j * ntp + i] = ax;
+    }
+    for (int j = 1; j < ntp; j++) {
+      fc.cutsq_2b[i * ntp + j] = cut[i][j] * cut[i][j];    // cutsq is set after init_one()
+      if (pot_3b) fc.cut_list[i * ntp + j] = cut_3b_list[i][j];
+    }
+  }
+
+  const int n2b_int = fc.tlow.size();
+  fc.coeff_2b.assign(4 * n2b_int, 0);
+  for (int iv = 0; iv < n2b_int; iv++)
+    for (int m = 0; m < 4; m++)
+      for (int p = 0; p < 4; p++) fc.coeff_2b[4 * iv + p] += fc.basis[16 * iv + 4 * m + p];
+
+  if (!pot_3b) return;
+
+  const int ntrip = ntp * ntp * ntp;
+  fc.cut_ij.assign(ntrip, 0);
+  fc.cut_ik.assign(ntrip, 0);
+  fc.cut_jk.assign(ntrip, 0);
+  fc.min_ij.assign(ntrip, 0);
+  fc.min_ik.assign(ntrip, 0);
+  fc.min_jk.assign(ntrip, 0);
+  fc.axis_3b.assign(ntrip, 0);
+  fc.off_3b.assign(ntrip, 0);
+  fc.stride1_3b.assign(ntrip, 0);
+  fc.stride2_3b.assign(ntrip, 0);
+
+  for (int i = 1; i < ntp; i++) {
+    for (int j = 1; j < ntp; j++) {
+      for (int k = 1; k < ntp; k++) {
+        const int t = (i * ntp + j) * ntp + k;
+        const int id = id_3b(i, j, k);
+        const uf3_interaction_3b &inter = interactions_3b[id];
+        // without 3-body term the zero cutoffs reject every triplet
+        if (inter.set != 1) continue;
+
+        // i-j-k and i-k-j share the axes and coefficients packed for
+        // j <= k, i-k-j steps through them with the ij and ik strides swapped
+        const int sw = (k < j) ? 1 : 0;
+        if (sw) {
+          const int tkj = (i * ntp + k) * ntp + j;
+          fc.axis_3b[t] = fc.axis_3b[tkj];
+          fc.off_3b[t] = fc.off_3b[tkj];
+          fc.stride1_3b[t] = fc.stride2_3b[tkj];
+          fc.stride2_3b[t] = fc.stride1_3b[tkj];
+        } else {
+          // knot vectors are numbered jk, ik, ij
+          fc.axis_3b[t] = pack_axis(fc, knots_3b(id, 2), nullptr, inter.knot_spacing);
+          pack_axis(fc, knots_3b(id, 1), nullptr, inter.knot_spacing);
+          pack_axis(fc, knots_3b(id, 0), nullptr, inter.knot_spacing);
+
+          const uf3_tensor_view coeff = coeff_3b(id);
+          const int d2 = coeff.dim[1];
+          const int d3 = coeff.dim[2];
+          fc.off_3b[t] = fc.coeff_3b.size();
+          fc.stride1_3b[t] = d2 * d3;
+          fc.stride2_3b[t] = d3;
+          for (int a = 0; a < coeff.dim[0]; a++)
+            for (int b = 0; b < d2; b++) {
+              const double *row = &coeff.data[a * coeff.stride[0] + b * coeff.stride[1]];
+              fc.coeff_3b.insert(fc.coeff_3b.end(), row, row + d3);
+            }
+        }
+
+        // cut and min_cut are ordered jk ik ij for j <= k
+        fc.cut_ij[t] = inter.cut[2 - sw];
+        fc.cut_ik[t] = inter.cut[1 + sw];
+        fc.cut_jk[t] = inter.cut[0];
+        fc.min_ij[t] = inter.min_cut[2 - sw];
+        fc.min_ik[t] = inter.min_cut[1 + sw];
+        fc.min_jk[t] = inter.min_cut[0];
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <class flt_t> double PairUF3Intel::ForceConst<flt_t>::memory_usage()
+{
+  double bytes = 0;
+  bytes += (double) (nint.size() + off.size() + nbucket.size() + boff.size() + bucket.size() +
+                     axis_2b.size() + axis_3b.size() + off_3b.size() + stride1_3b.size() +
+                     stride2_3b.size()) *
+      sizeof(int);
+  bytes += (double) (kstart.size() + inv_spacing.size() + tlow.size() + tnext.size() +
+                     basis.size() + coeff_2b.size() + cutsq_2b.size() + cut_list.size() +
+                     cut_ij.size() + cut_ik.size() + cut_jk.size() + min_ij.size() + min_ik.size() +
+                     min_jk.size() + coeff_3b.size()) *
+      sizeof(flt_t);
+  return bytes;
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairUF3Intel::memory_usage()
+{
+  double bytes = PairUF3::memory_usage();
+  bytes += (double) NFBUF * maxbuf * sizeof(double);
+  bytes += (double) NIBUF * maxbuf * sizeof(int);
+  bytes += force_const_single.memory_usage();
+  bytes += force_const_double.memory_usage();
+  return bytes;
+}
@@ -0,0 +1,97 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida), 
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+// clang-format off
+PairStyle(uf3/intel,PairUF3Intel);
+// clang-format on
+#else
+
+#ifndef LMP_PAIR_UF3_INTEL_H
+#define LMP_PAIR_UF3_INTEL_H
+
+#include "pair_uf3.h"
+
+#include <vector>
+
+namespace LAMMPS_NS {
+
+class PairUF3Intel : public PairUF3 {
+ public:
+  PairUF3Intel(class LAMMPS *);
+  ~PairUF3Intel() override;
+  void compute(int, int) override;
+  void settings(int, char **) override;
+  void coeff(int, char **) override;
+  void init_style() override;
+  double init_one(int, int) override;
+  double memory_usage() override;
+
+  // splines repacked into flat tables of per knot interval polynomials
+  // in the distance from the start of the interval
+  template <class flt_t> class ForceConst {
+   public:
+    // knot interval lookup, one entry per spline axis. the 2-body splines
+    // come first, followed by three axes (ij, ik, jk) per 3-body triplet type
+    std::vector<int> nint, off;
+    std::vector<flt_t> kstart, inv_spacing;    // of the knots, or of the buckets if non-uniform
+    std::vector<int> nbucket, boff;            // buckets of each axis, 0 for uniform knots
+    std::vector<int> bucket;                   // interval at the start of every bucket
+
+    std::vector<flt_t> tlow;       // start of every knot interval
+    std::vector<flt_t> tnext;      // start of the next interval of the same axis
+    std::vector<flt_t> basis;      // 4x4 coefficients of the 4 active bases per interval
+    std::vector<flt_t> coeff_2b;   // 4 coefficients of the 2-body energy per 2-body interval
+
+    // 2-body, indexed by type pair
+    std::vector<int> axis_2b;
+    std::vector<flt_t> cutsq_2b, cut_list;
+
+    // 3-body, indexed by triplet type (itype*(n+1)+jtype)*(n+1)+ktype,
+    // jtype > ktype points to the axes and coefficients of i-k-j
+    std::vector<flt_t> cut_ij, cut_ik, cut_jk, min_ij, min_ik, min_jk;
+    std::vector<int> axis_3b, off_3b, stride1_3b, stride2_3b;
+    std::vector<flt_t> coeff_3b;
+
+    double memory_usage();
+  };
+
+ protected:
+  int packed, packed_precision;    // precision_3b the tables were packed with
+  ForceConst<float> force_const_single;
+  ForceConst<double> force_const_double;
+
+  double **fbuf;    // per neighbor SoA buffers
+  int **ibuf;
+  int maxbuf;
+  void grow_buffers(int);
+
+  template <class flt_t> void pack_force_const(ForceConst<flt_t> &);
+  template <class flt_t>
+  int pack_axis(ForceConst<flt_t> &, const std::vector<double> &, const std::vector<double> *,
+                int);
+
+  template <class flt_t, class acc_t> void compute(ForceConst<flt_t> &);
+  template <class flt_t, class acc_t, int EVFLAG, int EFLAG> void eval(ForceConst<flt_t> &);
+};
+
+}    // namespace LAMMPS_NS
+
+#endif
+#endif
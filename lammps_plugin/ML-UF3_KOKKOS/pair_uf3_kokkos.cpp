@@ -34,6 +34,7 @@
 #include "neighbor.h"
 #include "pair_kokkos.h"
 #include "text_file_reader.h"
+#include "uf3_interval_table.h"
 #include <algorithm>
 #include <cmath>
 #include <utility>
@@ -52,6 +53,9 @@ template <class DeviceType> PairUF3Kokkos<DeviceType>::PairUF3Kokkos(LAMMPS *lmp
   execution_space = ExecutionSpaceFromDevice<DeviceType>::space;
   datamask_read = X_MASK | F_MASK | TAG_MASK | TYPE_MASK | ENERGY_MASK | VIRIAL_MASK;
   datamask_modify = F_MASK | ENERGY_MASK | VIRIAL_MASK;
+
+  // the views are filled from the potential files after create_bsplines()
+  keep_pot_data = 1;
 }
 
 template <class DeviceType> PairUF3Kokkos<DeviceType>::~PairUF3Kokkos()
@@ -61,34 +65,12 @@ template <class DeviceType> PairUF3Kokkos<DeviceType>::~PairUF3Kokkos()
                                               //Also set k_eatom to empty View
     memoryKK->destroy_kokkos(k_vatom, vatom);
     memoryKK->destroy_kokkos(k_cutsq,cutsq);
-    destroy_3d(k_cut_3b,cut_3b);
-    destroy_4d(k_min_cut_3b,min_cut_3b);
     eatom = NULL;
     vatom = NULL;
     cvatom = NULL;
   }
 }
 
-template <class DeviceType>
-template <typename TYPE> 
-void PairUF3Kokkos<DeviceType>::destroy_3d(TYPE data, typename TYPE::value_type*** &array)
-{
-  if (array == nullptr) return;
-  data = TYPE();
-  memory->sfree(array);
-  array = nullptr;
-}
-
-template <class DeviceType>
-template <typename TYPE> 
-void PairUF3Kokkos<DeviceType>::destroy_4d(TYPE data, typename TYPE::value_type**** &array)
-{
-  if (array == nullptr) return;
-  data = TYPE();
-  memory->sfree(array);
-  array = nullptr;
-}
-
 /* ----------------------------------------------------------------------
  *     global settings
  * ---------------------------------------------------------------------- */
@@ -98,6 +80,10 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::settings(int narg, c
   PairUF3::settings(narg, arg);
   //1. Determines whether the simulation is 2-body or 2 and 3-body
   //2. Set nbody_flag, num_of_elements, pot_3b
+
+  // the device tables are filled from the double precision host tensors
+  precision_3b = uf3_triplet_bspline::PREC_DOUBLE;
+  storage_3b = uf3_triplet_bspline::STORE_DOUBLE;
 }
 
 /* ----------------------------------------------------------------------
@@ -150,10 +136,6 @@ void PairUF3Kokkos<DeviceType>::allocate()
   d_cutsq = k_cutsq.template view<DeviceType>(); //assignment; get the device
   //view of k_cutsq and assign it to d_cutsq; in the header file we just
   //decleared d_cutsq's type
-  memoryKK->create_kokkos(k_cut_3b,n+1,n+1,n+1,"threebody:cut");
-  memoryKK->create_kokkos(k_min_cut_3b,n+1,n+1,n+1,3,"threebody:cut");
-  d_cut_3b = k_cut_3b.template view<DeviceType>();
-  d_min_cut_3b = k_min_cut_3b.template view<DeviceType>();
 }
 
 
@@ -168,23 +150,37 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::init_style()
 
   neighflag = lmp->kokkos->neighflag;
 
-  auto request = neighbor->find_request(this);
+  // 2-body list, half unless the full neighbor flag is selected
+
+  auto request = neighbor->find_request(this, 1);
   request->set_kokkos_host(std::is_same<DeviceType, LMPHostType>::value &&
                            !std::is_same<DeviceType, LMPDeviceType>::value);
   request->set_kokkos_device(std::is_same<DeviceType, LMPDeviceType>::value);
+  if (neighflag == FULL) request->enable_full();
 
-  request->enable_full();
-  request->enable_ghost();
+  // 3-body list, full with ghosts for the short neighbor list
+
+  if (pot_3b) {
+    request = neighbor->find_request(this, 2);
+    request->set_kokkos_host(std::is_same<DeviceType, LMPHostType>::value &&
+                             !std::is_same<DeviceType, LMPDeviceType>::value);
+    request->set_kokkos_device(std::is_same<DeviceType, LMPDeviceType>::value);
+    request->enable_full();
+    request->enable_ghost();
+  }
 }
 
 /* ----------------------------------------------------------------------
-   init list sets the pointer to full neighbour list requested in previous function
+   init list sets the pointers to the neighbour lists requested in init_style
 ------------------------------------------------------------------------- */
 
 template <class DeviceType>
-void PairUF3Kokkos<DeviceType>::init_list(int /*id*/, class NeighList *ptr)
+void PairUF3Kokkos<DeviceType>::init_list(int id, class NeighList *ptr)
 {
-  list = ptr;
+  if (id == 2)
+    list_3b = ptr;
+  else
+    list = ptr;
 }
 
 /* ----------------------------------------------------------------------
@@ -217,30 +213,6 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::create_coefficients(
     }
   }*/
 
-  if (pot_3b){
-    for (int i = 1; i < num_of_elements + 1; i++) {
-      for (int j = 1; j < num_of_elements + 1; j++) {
-        for (int k = 1; k < num_of_elements + 1; k++) {
-          /*if (UFBS3b[i][j][k].knot_spacing_type != 0)
-            error->all(FLERR,"UF3Kokkos: Currently only uniform knot-spacing is suupoted");*/
-          k_cut_3b.h_view(i,j,k) = cut_3b[i][j][k];
-
-          // Notice the order of min_cut_3b[i][j][k]
-          //In min_cut_3b[i][j][k],
-          //min_cut_3b[i][j][k][0] is the knot_vector along jk,
-          //min_cut_3b[i][j][k][1] is the knot_vector along ik,
-          //min_cut_3b[i][j][k][2] is the knot_vector along ij,
-          //see pair_uf3.cpp for more details
-          k_min_cut_3b.h_view(i,j,k,0) = min_cut_3b[i][j][k][0];
-          k_min_cut_3b.h_view(i,j,k,1) = min_cut_3b[i][j][k][1];
-          k_min_cut_3b.h_view(i,j,k,2) = min_cut_3b[i][j][k][2];
-          //k_cut_3b.h_view(i,k,j) = cut_3b[i][k][j];
-        }
-      }
-    }
-    k_cut_3b.template modify<LMPHostType>();
-    k_min_cut_3b.template modify<LMPHostType>();
-  }
   //copy_2d(d_cutsq, cutsq, num_of_elements + 1, num_of_elements + 1); //copy cutsq from
   //host to device memory
   /*if (pot_3b) {
@@ -261,6 +233,10 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::create_coefficients(
   create_2b_coefficients();
   if (pot_3b) create_3b_coefficients();
 
+  // the views hold everything the kernels need, the potential files and
+  // the host 3-body splines are not used anymore
+  release_pot_data();
+  std::vector<uf3_triplet_bspline>().swap(bsplines_3b);
 }
 
 template <class DeviceType> void PairUF3Kokkos<DeviceType>::create_2b_coefficients()
@@ -283,303 +259,327 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::create_2b_coefficien
   // Count max knots for array size
 
   int max_knots = 0;
-  for (int i = 1; i < n2b_knot.size(); i++)
-    for (int j = i; j < n2b_knot[i].size(); j++) max_knots = max(max_knots, n2b_knot[i][j].size());
-
-  // Copy coefficients to view
-
-  Kokkos::realloc(d_coefficients_2b, interaction_count, max_knots - 4);
-  auto d_coefficients_2b_view = Kokkos::create_mirror(d_coefficients_2b);
-
-  for (int i = 1; i < num_of_elements + 1; i++) {
-    for (int j = i; j < num_of_elements + 1; j++) {
-      for (int k = 0; k < n2b_coeff[i][j].size(); k++) {
-        d_coefficients_2b_view(map2b_view(i, j), k) = n2b_coeff[i][j][k];
-      }
-    }
-  }
-  Kokkos::deep_copy(d_coefficients_2b, d_coefficients_2b_view);
+  for (int i = 1; i < num_of_elements + 1; i++)
+    for (int j = i; j < num_of_elements + 1; j++)
+      max_knots = max(max_knots, (int) knots_2b(i, j).size());
 
   // Copy knots from array to view
 
   Kokkos::realloc(d_n2b_knot, interaction_count, max_knots);
-  Kokkos::realloc(d_n2b_knot_spacings, interaction_count);
   auto d_n2b_knot_view = Kokkos::create_mirror(d_n2b_knot);
-  auto d_n2b_knot_spacings_view = Kokkos::create_mirror(d_n2b_knot_spacings);
 
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = i; j < num_of_elements + 1; j++) {
-      for (int k = 0; k < n2b_knot[i][j].size(); k++) {
-        d_n2b_knot_view(map2b_view(i, j), k) = n2b_knot[i][j][k];
+      const std::vector<double> &knots = knots_2b(i, j);
+      for (int k = 0; k < knots.size(); k++) {
+        d_n2b_knot_view(map2b_view(i, j), k) = knots[k];
       }
-      d_n2b_knot_spacings_view(map2b_view(i, j)) = UFBS2b[i][j].knot_spacing;
     }
   }
 
   Kokkos::deep_copy(d_n2b_knot, d_n2b_knot_view);
-  Kokkos::deep_copy(d_n2b_knot_spacings, d_n2b_knot_spacings_view);
-  // Set spline constants
 
-  Kokkos::realloc(constants_2b, interaction_count, max_knots - 4);
-  auto constants_2b_view = Kokkos::create_mirror(constants_2b);
+  // Knot interval lookup
+
+  Kokkos::realloc(d_n2b_lookup, interaction_count);
+  Kokkos::realloc(d_n2b_lookup_index, interaction_count);
+  auto d_n2b_lookup_view = Kokkos::create_mirror(d_n2b_lookup);
+  auto d_n2b_lookup_index_view = Kokkos::create_mirror(d_n2b_lookup_index);
+  std::vector<std::vector<int>> buckets(interaction_count);
+  int max_bucket = 1;
 
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = i; j < num_of_elements + 1; j++) {
-      for (int l = 0; l < n2b_knot[i][j].size() - 4; l++) {
-        auto c = get_constants(&n2b_knot[i][j][l], n2b_coeff[i][j][l]);
-        for (int k = 0; k < 16; k++)
-          constants_2b_view(map2b_view(i, j), l, k) = (std::isinf(c[k]) || std::isnan(c[k])) ? 0
-                                                                                             : c[k];
-      }
+      const int id = map2b_view(i, j);
+      double lookup[2];
+      int lookup_index[3];
+      knot_lookup(knots_2b(i, j), knot_spacing_type_2b[i][j], lookup, lookup_index, buckets[id]);
+      for (int m = 0; m < 2; m++) d_n2b_lookup_view(id, m) = lookup[m];
+      for (int m = 0; m < 3; m++) d_n2b_lookup_index_view(id, m) = lookup_index[m];
+      max_bucket = max(max_bucket, (int) buckets[id].size());
     }
   }
-  Kokkos::deep_copy(constants_2b, constants_2b_view);
 
-  Kokkos::realloc(dnconstants_2b, interaction_count, max_knots - 5);
-  auto dnconstants_2b_view = Kokkos::create_mirror(dnconstants_2b);
+  Kokkos::realloc(d_n2b_bucket, interaction_count, max_bucket);
+  auto d_n2b_bucket_view = Kokkos::create_mirror(d_n2b_bucket);
+  for (int id = 0; id < interaction_count; id++)
+    for (int b = 0; b < buckets[id].size(); b++) d_n2b_bucket_view(id, b) = buckets[id][b];
+
+  Kokkos::deep_copy(d_n2b_lookup, d_n2b_lookup_view);
+  Kokkos::deep_copy(d_n2b_lookup_index, d_n2b_lookup_index_view);
+  Kokkos::deep_copy(d_n2b_bucket, d_n2b_bucket_view);
+  // Collapse the four basis functions active on each knot interval into a
+  // single cubic in r for the energy and a quadratic for its derivative.
+  // Interval s spans [knot[s], knot[s+1]) and carries bases s-3 .. s.
+
+  Kokkos::realloc(cubic_2b, interaction_count, max_knots - 4);
+  Kokkos::realloc(dncubic_2b, interaction_count, max_knots - 4);
+  auto cubic_2b_view = Kokkos::create_mirror(cubic_2b);
+  auto dncubic_2b_view = Kokkos::create_mirror(dncubic_2b);
+  Kokkos::deep_copy(cubic_2b_view, 0.0);
+  Kokkos::deep_copy(dncubic_2b_view, 0.0);
 
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = i; j < num_of_elements + 1; j++) {
-      for (int l = 0; l < n2b_knot[i][j].size() - 5; l++) {
-        double dntemp4 = 3 / (n2b_knot[i][j][l + 4] - n2b_knot[i][j][l + 1]);
-        double coeff = (n2b_coeff[i][j][l + 1] - n2b_coeff[i][j][l]) * dntemp4;
-        auto c = get_dnconstants(&n2b_knot[i][j][l + 1], coeff);
-        for (int k = 0; k < 9; k++)
-          dnconstants_2b_view(map2b_view(i, j), l, k) =
-              (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
+      const int id = map2b_view(i, j);
+      const std::vector<double> &knots = knots_2b(i, j);
+      const std::vector<double> &coeff = coeff_2b(i, j);
+      const int nknots = knots.size();
+      for (int l = 0; l < nknots - 4; l++) {
+        auto c = get_constants(&knots[l], coeff[l]);
+        // basis l contributes its piece m to interval l+m
+        for (int m = 0; m < 4 && l + m < nknots - 4; m++) {
+          for (int k = 0; k < 4; k++) {
+            const double ck = c[4 * m + k];
+            if (!std::isinf(ck) && !std::isnan(ck)) cubic_2b_view(id, l + m, k) += ck;
+          }
+        }
+      }
+      for (int l = 0; l < nknots - 5; l++) {
+        double dntemp4 = 3 / (knots[l + 4] - knots[l + 1]);
+        double dncoeff = (coeff[l + 1] - coeff[l]) * dntemp4;
+        auto c = get_dnconstants(&knots[l + 1], dncoeff);
+        // derivative basis l contributes its piece m to interval l+1+m
+        for (int m = 0; m < 3 && l + 1 + m < nknots - 4; m++) {
+          for (int k = 0; k < 3; k++) {
+            const double ck = c[3 * m + k];
+            if (!std::isinf(ck) && !std::isnan(ck)) dncubic_2b_view(id, l + 1 + m, k) += ck;
+          }
+        }
       }
     }
   }
-  Kokkos::deep_copy(dnconstants_2b, dnconstants_2b_view);
+  Kokkos::deep_copy(cubic_2b, cubic_2b_view);
+  Kokkos::deep_copy(dncubic_2b, dncubic_2b_view);
 }
 
 template <class DeviceType> void PairUF3Kokkos<DeviceType>::create_3b_coefficients()
 {
-  // Init interaction map for 3B
+  // Init interaction map for 3B. Only the interactions with a 3-body term
+  // get an id, i-j-k and i-k-j share the one stored for jtype <= ktype.
+  // threebody() swaps the ij and ik axes for jtype > ktype
 
   Kokkos::realloc(map3b, num_of_elements + 1, num_of_elements + 1, num_of_elements + 1);
   auto map3b_view = Kokkos::create_mirror(map3b);
+  Kokkos::deep_copy(map3b_view, -1);
 
-  int interaction_count = 0;
+  std::vector<int> host_id;    // interaction of PairUF3 behind every id
   for (int i = 1; i < num_of_elements + 1; i++) {
     for (int j = 1; j < num_of_elements + 1; j++) {
-      for (int k = 1; k < num_of_elements + 1; k++) {
-        map3b_view(i, j, k) = interaction_count;
-        interaction_count++;
-       // map3b_view(i, k, j) = interaction_count++;
+      for (int k = j; k < num_of_elements + 1; k++) {
+        if (interactions_3b[id_3b(i, j, k)].set != 1) continue;
+        map3b_view(i, j, k) = map3b_view(i, k, j) = (int) host_id.size();
+        host_id.push_back(id_3b(i, j, k));
       }
     }
   }
+  const int interaction_count = host_id.size();
   Kokkos::deep_copy(map3b, map3b_view);
 
-  // Count max knots for view
+  // 3-body list cutoffs per type pair, zero for the types no interaction
+  // of itype needs, which keeps them out of the short neighbor list
+
+  Kokkos::realloc(d_cut_3b_list, num_of_elements + 1, num_of_elements + 1);
+  auto d_cut_3b_list_view = Kokkos::create_mirror(d_cut_3b_list);
+  for (int i = 1; i < num_of_elements + 1; i++)
+    for (int j = 1; j < num_of_elements + 1; j++) d_cut_3b_list_view(i, j) = cut_3b_list[i][j];
+  Kokkos::deep_copy(d_cut_3b_list, d_cut_3b_list_view);
+
+  // Cutoffs and first knots, ordered jk, ik, ij
+
+  Kokkos::realloc(d_cut_3b, interaction_count);
+  Kokkos::realloc(d_min_cut_3b, interaction_count);
+  auto d_cut_3b_view = Kokkos::create_mirror(d_cut_3b);
+  auto d_min_cut_3b_view = Kokkos::create_mirror(d_min_cut_3b);
+  for (int id = 0; id < interaction_count; id++)
+    for (int d = 0; d < 3; d++) {
+      d_cut_3b_view(id, d) = interactions_3b[host_id[id]].cut[d];
+      d_min_cut_3b_view(id, d) = interactions_3b[host_id[id]].min_cut[d];
+    }
+  Kokkos::deep_copy(d_cut_3b, d_cut_3b_view);
+  Kokkos::deep_copy(d_min_cut_3b, d_min_cut_3b_view);
+
+  // Count max knots for view, at least 4 for the constants without interactions
 
-  int max_knots = 0;
-  //In n3b_knot_matrix[i][j][k],
-  //n3b_knot_matrix[i][j][k][0] is the knot_vector along jk,
-  //n3b_knot_matrix[i][j][k][1] is the knot_vector along ik,
-  //n3b_knot_matrix[i][j][k][2] is the knot_vector along ij,
+  int max_knots = 4;
+  //knots_3b(id, 0) is the knot_vector along jk,
+  //knots_3b(id, 1) is the knot_vector along ik,
+  //knots_3b(id, 2) is the knot_vector along ij,
   //see pair_uf3.cpp for more details
 
-  for (int i = 1; i < n3b_knot_matrix.size(); i++)
-    for (int j = 1; j < n3b_knot_matrix[i].size(); j++)
-      for (int k = 1; k < n3b_knot_matrix[i][j].size(); k++)
-        max_knots =
-            max(max_knots,
-                max(n3b_knot_matrix[i][j][k][0].size(),
-                    max(n3b_knot_matrix[i][j][k][1].size(), n3b_knot_matrix[i][j][k][2].size())));
+  for (int id = 0; id < interaction_count; id++)
+    for (int d = 0; d < 3; d++) max_knots = max(max_knots, (int) knots_3b(host_id[id], d).size());
 
   // Init knot matrix view
 
   Kokkos::realloc(d_n3b_knot_matrix, interaction_count, 3, max_knots);
-  Kokkos::realloc(d_n3b_knot_matrix_spacings, interaction_count, 3);
   auto d_n3b_knot_matrix_view = Kokkos::create_mirror(d_n3b_knot_matrix);
-  auto d_n3b_knot_matrix_spacings_view = Kokkos::create_mirror(d_n3b_knot_matrix_spacings);
-
-  for (int i = 1; i < n3b_knot_matrix.size(); i++)
-    for (int j = 1; j < n3b_knot_matrix[i].size(); j++)
-      for (int k = 1; k < n3b_knot_matrix[i][j].size(); k++) {
-        for (int m = 0; m < n3b_knot_matrix[i][j][k][0].size(); m++)
-          d_n3b_knot_matrix_view(map3b_view(i, j, k), 0, m) = n3b_knot_matrix[i][j][k][0][m];
-        for (int m = 0; m < n3b_knot_matrix[i][j][k][1].size(); m++)
-          d_n3b_knot_matrix_view(map3b_view(i, j, k), 1, m) = n3b_knot_matrix[i][j][k][1][m];
-        for (int m = 0; m < n3b_knot_matrix[i][j][k][2].size(); m++)
-          d_n3b_knot_matrix_view(map3b_view(i, j, k), 2, m) = n3b_knot_matrix[i][j][k][2][m];
-
-        d_n3b_knot_matrix_spacings_view(map3b_view(i, j, k),2) = UFBS3b[i][j][k].knot_spacing_ij;
-        d_n3b_knot_matrix_spacings_view(map3b_view(i, j, k),1) = UFBS3b[i][j][k].knot_spacing_ik;
-        d_n3b_knot_matrix_spacings_view(map3b_view(i, j, k),0) = UFBS3b[i][j][k].knot_spacing_jk;
-      }
-  Kokkos::deep_copy(d_n3b_knot_matrix, d_n3b_knot_matrix_view);
-  Kokkos::deep_copy(d_n3b_knot_matrix_spacings, d_n3b_knot_matrix_spacings_view);
-
-  // Set knots spacings
 
-  Kokkos::realloc(d_n3b_knot_spacings, interaction_count, 3);
-  auto d_n3b_knot_spacings_view = Kokkos::create_mirror(d_n3b_knot_spacings);
+  for (int id = 0; id < interaction_count; id++)
+    for (int d = 0; d < 3; d++) {
+      const std::vector<double> &knots = knots_3b(host_id[id], d);
+      for (int m = 0; m < knots.size(); m++) d_n3b_knot_matrix_view(id, d, m) = knots[m];
+    }
+  Kokkos::deep_copy(d_n3b_knot_matrix, d_n3b_knot_matrix_view);
 
-  for (int i = 1; i < num_of_elements + 1; i++) {
-    for (int j = 1; j < num_of_elements + 1; j++) {
-      for (int k = 1; k < num_of_elements + 1; k++) {
-        d_n3b_knot_spacings_view(map3b_view(i, j, k), 0) =
-            1 / (n3b_knot_matrix[i][j][k][0][5] - n3b_knot_matrix[i][j][k][0][4]);
-        d_n3b_knot_spacings_view(map3b_view(i, j, k), 1) =
-            1 / (n3b_knot_matrix[i][j][k][1][5] - n3b_knot_matrix[i][j][k][1][4]);
-        d_n3b_knot_spacings_view(map3b_view(i, j, k), 2) =
-            1 / (n3b_knot_matrix[i][j][k][2][5] - n3b_knot_matrix[i][j][k][2][4]);
-      }
+  // Knot interval lookup, indexed like d_n3b_knot_matrix
+
+  Kokkos::realloc(d_n3b_lookup, interaction_count, 3);
+  Kokkos::realloc(d_n3b_lookup_index, interaction_count, 3);
+  auto d_n3b_lookup_view = Kokkos::create_mirror(d_n3b_lookup);
+  auto d_n3b_lookup_index_view = Kokkos::create_mirror(d_n3b_lookup_index);
+  std::vector<std::vector<int>> buckets(3 * interaction_count);
+  int max_bucket = 1;
+
+  for (int id = 0; id < interaction_count; id++)
+    for (int d = 0; d < 3; d++) {
+      double lookup[2];
+      int lookup_index[3];
+      knot_lookup(knots_3b(host_id[id], d), interactions_3b[host_id[id]].knot_spacing, lookup,
+                  lookup_index, buckets[3 * id + d]);
+      for (int m = 0; m < 2; m++) d_n3b_lookup_view(id, d, m) = lookup[m];
+      for (int m = 0; m < 3; m++) d_n3b_lookup_index_view(id, d, m) = lookup_index[m];
+      max_bucket = max(max_bucket, (int) buckets[3 * id + d].size());
     }
-  }
-  Kokkos::deep_copy(d_n3b_knot_spacings, d_n3b_knot_spacings_view);
 
-  // Copy coefficients
+  Kokkos::realloc(d_n3b_bucket, interaction_count, 3, max_bucket);
+  auto d_n3b_bucket_view = Kokkos::create_mirror(d_n3b_bucket);
+  for (int id = 0; id < interaction_count; id++)
+    for (int d = 0; d < 3; d++)
+      for (int b = 0; b < buckets[3 * id + d].size(); b++)
+        d_n3b_bucket_view(id, d, b) = buckets[3 * id + d][b];
+
+  Kokkos::deep_copy(d_n3b_lookup, d_n3b_lookup_view);
+  Kokkos::deep_copy(d_n3b_lookup_index, d_n3b_lookup_index_view);
+  Kokkos::deep_copy(d_n3b_bucket, d_n3b_bucket_view);
+
+  // Copy coefficients. The tensors are stored one after the other without
+  // padding, d_coefficients_3b_index holds the offset and the ik and jk
+  // dimensions of every tensor. The tensors are read in place from the
+  // potential files and packed by the host threads.
+
+  std::vector<uf3_tensor_view> coeff_view(interaction_count);
+  Kokkos::realloc(d_coefficients_3b_index, interaction_count);
+  auto d_coefficients_3b_index_view = Kokkos::create_mirror(d_coefficients_3b_index);
+  int coeff_size = 0;
+  for (int id = 0; id < interaction_count; id++) {
+    const uf3_tensor_view c = coeff_3b(host_id[id]);
+    coeff_view[id] = c;
+    d_coefficients_3b_index_view(id, 0) = coeff_size;
+    d_coefficients_3b_index_view(id, 1) = c.dim[1];
+    d_coefficients_3b_index_view(id, 2) = c.dim[2];
+    coeff_size += c.dim[0] * c.dim[1] * c.dim[2];
+  }
+  Kokkos::deep_copy(d_coefficients_3b_index, d_coefficients_3b_index_view);
 
-  Kokkos::realloc(d_coefficients_3b, interaction_count, max_knots - 4, max_knots - 4,
-                  max_knots - 4);
+  Kokkos::realloc(d_coefficients_3b, coeff_size);
   auto d_coefficients_3b_view = Kokkos::create_mirror(d_coefficients_3b);
-
-  for (int n = 1; n < num_of_elements + 1; n++) {
-    for (int m = 1; m < num_of_elements + 1; m++) {
-      for (int o = 1; o < num_of_elements + 1; o++) {
-        std::string key = std::to_string(n) + std::to_string(m) + std::to_string(o);
-        for (int i = 0; i < n3b_coeff_matrix[key].size(); i++) {
-          for (int j = 0; j < n3b_coeff_matrix[key][i].size(); j++) {
-            for (int k = 0; k < n3b_coeff_matrix[key][i][j].size() - 1; k++) {
-              d_coefficients_3b_view(map3b_view(n, m, o), i, j, k) = n3b_coeff_matrix[key][i][j][k];
-            }
-          }
-        }
+  Kokkos::parallel_for(Kokkos::RangePolicy<LMPHostType>(0, interaction_count), [&](const int id) {
+    const uf3_tensor_view &c = coeff_view[id];
+    F_FLOAT *dst = d_coefficients_3b_view.data() + d_coefficients_3b_index_view(id, 0);
+    for (int i = 0; i < c.dim[0]; i++)
+      for (int j = 0; j < c.dim[1]; j++) {
+        const double *row = &c.data[i * c.stride[0] + j * c.stride[1]];
+        dst = std::copy(row, row + c.dim[2], dst);
       }
-    }
-  }
+  });
   Kokkos::deep_copy(d_coefficients_3b, d_coefficients_3b_view);
-  //
-  // Create derivative coefficients
 
-  // TODO: Shrink size
-  Kokkos::realloc(d_dncoefficients_3b, interaction_count, 3, max_knots - 4, max_knots - 4,
-                  max_knots - 4);
-  auto d_dncoefficients_3b_view = Kokkos::create_mirror(d_dncoefficients_3b);
+  // Set spline constants. The derivatives of the spline are contractions of
+  // the same coefficients with the derivatives of these cubics, so neither
+  // derivative coefficients nor derivative constants are stored.
 
-  //Notice the order for d_dncoefficients_3b_view(map3b_view(n, m, o), X, i, j, k)
-  //d_dncoefficients_3b_view(map3b_view(n, m, o), 2, i, j, k) --> coeff for rjk
-  //d_dncoefficients_3b_view(map3b_view(n, m, o), 1, i, j, k) --> coeff for rik
-  //d_dncoefficients_3b_view(map3b_view(n, m, o), 0, i, j, k) --> coeff for rij
-  //
-  //This is because-
-  //In n3b_knot_matrix[i][j][k],
-  //n3b_knot_matrix[i][j][k][0] is the knot_vector along jk,
-  //n3b_knot_matrix[i][j][k][1] is the knot_vector along ik,
-  //n3b_knot_matrix[i][j][k][2] is the knot_vector along ij,
-  //see pair_uf3.cpp for more details
+  Kokkos::realloc(constants_3b, interaction_count, 3, max_knots - 4);
+  auto constants_3b_view = Kokkos::create_mirror(constants_3b);
 
-  for (int n = 1; n < num_of_elements + 1; n++) {
-    for (int m = 1; m < num_of_elements + 1; m++) {
-      for (int o = 1; o < num_of_elements + 1; o++) {
-        std::string key = std::to_string(n) + std::to_string(m) + std::to_string(o);
-        for (int i = 0; i < n3b_coeff_matrix[key].size(); i++) {
-          for (int j = 0; j < n3b_coeff_matrix[key][i].size(); j++) {
-            for (int k = 0; k < n3b_coeff_matrix[key][i][j].size() - 1; k++) {
-              F_FLOAT dntemp4 =
-                  3 / (n3b_knot_matrix[n][m][o][0][k + 4] - n3b_knot_matrix[n][m][o][0][k + 1]);
-              d_dncoefficients_3b_view(map3b_view(n, m, o), 2, i, j, k) =
-                  (n3b_coeff_matrix[key][i][j][k + 1] - n3b_coeff_matrix[key][i][j][k]) * dntemp4;
-            }
-          }
-        }
+  //knots_3b(id, 0..2) are ordered jk, ik, ij,
+  //constants_3b(id, 0..2) are ordered ij, ik, jk
+  Kokkos::parallel_for(Kokkos::RangePolicy<LMPHostType>(0, 3 * interaction_count),
+                       [&](const int idd) {
+    const std::vector<double> &knots = knots_3b(host_id[idd / 3], 2 - idd % 3);
+    for (int l = 0; l < (int) knots.size() - 4; l++) {
+      auto c = get_constants(&knots[l], 1);
+      for (int k = 0; k < 16; k++)
+        constants_3b_view(idd / 3, idd % 3, l, k) =
+            (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
+    }
+  });
+  Kokkos::deep_copy(constants_3b, constants_3b_view);
 
-        for (int i = 0; i < n3b_coeff_matrix[key].size(); i++) {
-          std::vector<std::vector<F_FLOAT>> dncoeff_vect2;
-          for (int j = 0; j < n3b_coeff_matrix[key][i].size() - 1; j++) {
-            F_FLOAT dntemp4 =
-                3 / (n3b_knot_matrix[n][m][o][1][j + 4] - n3b_knot_matrix[n][m][o][1][j + 1]);
-            std::vector<F_FLOAT> dncoeff_vect;
-            for (int k = 0; k < n3b_coeff_matrix[key][i][j].size(); k++) {
-              d_dncoefficients_3b_view(map3b_view(n, m, o), 1, i, j, k) =
-                  (n3b_coeff_matrix[key][i][j + 1][k] - n3b_coeff_matrix[key][i][j][k]) * dntemp4;
-            }
-          }
-        }
+  // Copy the tricubics built by uf3_triplet_bspline into one flat view
 
-        for (int i = 0; i < n3b_coeff_matrix[key].size() - 1; i++) {
-          F_FLOAT dntemp4 =
-              3 / (n3b_knot_matrix[n][m][o][2][i + 4] - n3b_knot_matrix[n][m][o][2][i + 1]);
-          for (int j = 0; j < n3b_coeff_matrix[key][i].size(); j++) {
-            for (int k = 0; k < n3b_coeff_matrix[key][i][j].size(); k++) {
-              d_dncoefficients_3b_view(map3b_view(n, m, o), 0, i, j, k) =
-                  (n3b_coeff_matrix[key][i + 1][j][k] - n3b_coeff_matrix[key][i][j][k]) * dntemp4;
-            }
-          }
-        }
-      }
+  Kokkos::realloc(d_tricubic_3b_index, interaction_count);
+  auto d_tricubic_3b_index_view = Kokkos::create_mirror(d_tricubic_3b_index);
+
+  int tricubic_size = 0;
+  for (int id = 0; id < interaction_count; id++) {
+    const uf3_triplet_bspline &bspline = bsplines_3b[host_id[id]];
+    d_tricubic_3b_index_view(id, 0) = -1;
+    d_tricubic_3b_index_view(id, 1) = bspline.get_nint(1);
+    d_tricubic_3b_index_view(id, 2) = bspline.get_nint(0);
+    if (bspline.representation() == uf3_triplet_bspline::REPR_TRICUBIC) {
+      d_tricubic_3b_index_view(id, 0) = tricubic_size;
+      tricubic_size += 64 * bspline.get_nint(2) * bspline.get_nint(1) * bspline.get_nint(0);
     }
   }
-  Kokkos::deep_copy(d_dncoefficients_3b, d_dncoefficients_3b_view);
+  Kokkos::deep_copy(d_tricubic_3b_index, d_tricubic_3b_index_view);
+
+  Kokkos::realloc(d_tricubic_3b, tricubic_size);
+  auto d_tricubic_3b_view = Kokkos::create_mirror(d_tricubic_3b);
+
+  Kokkos::parallel_for(Kokkos::RangePolicy<LMPHostType>(0, interaction_count), [&](const int id) {
+    if (d_tricubic_3b_index_view(id, 0) < 0) return;
+    const uf3_triplet_bspline &bspline = bsplines_3b[host_id[id]];
+    const double *tricubic = bspline.get_tricubic();
+    const int size = 64 * bspline.get_nint(2) * bspline.get_nint(1) * bspline.get_nint(0);
+    std::copy(tricubic, tricubic + size, &d_tricubic_3b_view(d_tricubic_3b_index_view(id, 0)));
+  });
+  Kokkos::deep_copy(d_tricubic_3b, d_tricubic_3b_view);
+}
 
-  // Set spline constants
+// Start and inverse width of the interval lookup of [knots], and uniform,
+// number of buckets and number of intervals. Non-uniform knots get the
+// bucket table of uf3_interval_table, or none if they cannot have one.
 
-  Kokkos::realloc(constants_3b, interaction_count, 3, max_knots - 4);
-  auto constants_3b_view = Kokkos::create_mirror(constants_3b);
+template <class DeviceType>
+void PairUF3Kokkos<DeviceType>::knot_lookup(const std::vector<double> &knots, int spacing_type,
+                                            double *lookup, int *lookup_index,
+                                            std::vector<int> &bucket)
+{
+  lookup[0] = knots[3];
+  lookup[1] = 1.0 / (knots[4] - knots[3]);
+  bucket.clear();
+  lookup_index[0] = (spacing_type == 0) ? 1 : 0;
+  if (!lookup_index[0] && !uf3_interval_table::make_buckets(knots, lookup[0], lookup[1], bucket))
+    lookup[1] = 0.0;
+  lookup_index[1] = bucket.size();
+  lookup_index[2] = knots.size() - 7;
+}
 
-  //In n3b_knot_matrix[i][j][k],
-  //n3b_knot_matrix[i][j][k][0] is the knot_vector along jk,
-  //n3b_knot_matrix[i][j][k][1] is the knot_vector along ik,
-  //n3b_knot_matrix[i][j][k][2] is the knot_vector along ij,
-  //see pair_uf3.cpp for more details
-  for (int n = 1; n < num_of_elements + 1; n++) {
-    for (int m = 1; m < num_of_elements + 1; m++) {
-      for (int o = 1; o < num_of_elements + 1; o++) {
-        for (int l = 0; l < n3b_knot_matrix[n][m][o][2].size() - 4; l++) {
-          auto c = get_constants(&n3b_knot_matrix[n][m][o][2][l], 1);
-          for (int k = 0; k < 16; k++)
-            constants_3b_view(map3b_view(n, m, o), 0, l, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-        for (int l = 0; l < n3b_knot_matrix[n][m][o][1].size() - 4; l++) {
-          auto c = get_constants(&n3b_knot_matrix[n][m][o][1][l], 1);
-          for (int k = 0; k < 16; k++)
-            constants_3b_view(map3b_view(n, m, o), 1, l, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-        for (int l = 0; l < n3b_knot_matrix[n][m][o][0].size() - 4; l++) {
-          auto c = get_constants(&n3b_knot_matrix[n][m][o][0][l], 1);
-          for (int k = 0; k < 16; k++)
-            constants_3b_view(map3b_view(n, m, o), 2, l, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-      }
-    }
-  }
-  Kokkos::deep_copy(constants_3b, constants_3b_view);
+// Index s of the knot interval [knots(s), knots(s+1)) containing r, values
+// outside the knots are assigned to the first/last interval
 
-  Kokkos::realloc(dnconstants_3b, interaction_count, 3, max_knots - 6);
-  auto dnconstants_3b_view = Kokkos::create_mirror(dnconstants_3b);
-
-  for (int n = 1; n < num_of_elements + 1; n++) {
-    for (int m = 1; m < num_of_elements + 1; m++) {
-      for (int o = 1; o < num_of_elements + 1; o++) {
-        for (int l = 1; l < n3b_knot_matrix[n][m][o][2].size() - 5; l++) {
-          auto c = get_dnconstants(&n3b_knot_matrix[n][m][o][2][l], 1);
-          for (int k = 0; k < 9; k++)
-            dnconstants_3b_view(map3b_view(n, m, o), 0, l - 1, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-        for (int l = 1; l < n3b_knot_matrix[n][m][o][1].size() - 5; l++) {
-          auto c = get_dnconstants(&n3b_knot_matrix[n][m][o][1][l], 1);
-          for (int k = 0; k < 9; k++)
-            dnconstants_3b_view(map3b_view(n, m, o), 1, l - 1, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-        for (int l = 1; l < n3b_knot_matrix[n][m][o][0].size() - 5; l++) {
-          auto c = get_dnconstants(&n3b_knot_matrix[n][m][o][0][l], 1);
-          for (int k = 0; k < 9; k++)
-            dnconstants_3b_view(map3b_view(n, m, o), 2, l - 1, k) =
-                (std::isinf(c[k]) || std::isnan(c[k])) ? 0 : c[k];
-        }
-      }
+template <class DeviceType>
+template <class KnotView, class BucketView>
+KOKKOS_INLINE_FUNCTION int
+PairUF3Kokkos<DeviceType>::knot_interval(const F_FLOAT r, const KnotView &knots,
+                                         const BucketView &bucket, const F_FLOAT start,
+                                         const F_FLOAT inv, const int uniform, const int nbucket,
+                                         const int nint)
+{
+  int idx = static_cast<int>((r - start) * inv);
+  if (!uniform) {
+    if (nbucket) {
+      idx = (idx < 0) ? 0 : idx;
+      idx = bucket((idx > nbucket - 1) ? nbucket - 1 : idx);
+      for (int m = 0; m < 2; m++) idx += (idx < nint - 1 && r >= knots(idx + 4)) ? 1 : 0;
+    } else {
+      idx = 0;
+      for (int m = 1; m < nint; m++) idx += (r >= knots(m + 3)) ? 1 : 0;
     }
   }
-  Kokkos::deep_copy(dnconstants_3b, dnconstants_3b_view);
+  idx = (idx < 0) ? 0 : idx;
+  return 3 + ((idx > nint - 1) ? nint - 1 : idx);
 }
 
 template <class DeviceType>
@@ -591,46 +591,21 @@ KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::twobody(const int itype,
 
   // Find knot starting position
   int interaction_id = map2b(itype, jtype);
-  int start_index = 3;
-  while (r > d_n2b_knot(interaction_id, start_index + 1)) start_index++;
-  //int start_index = 3+(int)((r-d_n2b_knot(interaction_id,0))/d_n2b_knot_spacings(interaction_id));
-
-  F_FLOAT r_values[4];
-  r_values[0] = 1;
-  r_values[1] = r;
-  r_values[2] = r_values[1] * r_values[1];
-
+  const int start_index = knot_interval(
+      r, Kokkos::subview(d_n2b_knot, interaction_id, Kokkos::ALL),
+      Kokkos::subview(d_n2b_bucket, interaction_id, Kokkos::ALL),
+      d_n2b_lookup(interaction_id, 0), d_n2b_lookup(interaction_id, 1),
+      d_n2b_lookup_index(interaction_id, 0), d_n2b_lookup_index(interaction_id, 1),
+      d_n2b_lookup_index(interaction_id, 2));
+
+  // Evaluate the per-interval polynomials with Horner's scheme
   if (EVFLAG) {
-    r_values[3] = r_values[2] * r_values[1];
-    // Calculate energy
-    evdwl = constants_2b(interaction_id, start_index, 0);
-    evdwl += r_values[1] * constants_2b(interaction_id, start_index, 1);
-    evdwl += r_values[2] * constants_2b(interaction_id, start_index, 2);
-    evdwl += r_values[3] * constants_2b(interaction_id, start_index, 3);
-    evdwl += constants_2b(interaction_id, start_index - 1, 4);
-    evdwl += r_values[1] * constants_2b(interaction_id, start_index - 1, 5);
-    evdwl += r_values[2] * constants_2b(interaction_id, start_index - 1, 6);
-    evdwl += r_values[3] * constants_2b(interaction_id, start_index - 1, 7);
-    evdwl += constants_2b(interaction_id, start_index - 2, 8);
-    evdwl += r_values[1] * constants_2b(interaction_id, start_index - 2, 9);
-    evdwl += r_values[2] * constants_2b(interaction_id, start_index - 2, 10);
-    evdwl += r_values[3] * constants_2b(interaction_id, start_index - 2, 11);
-    evdwl += constants_2b(interaction_id, start_index - 3, 12);
-    evdwl += r_values[1] * constants_2b(interaction_id, start_index - 3, 13);
-    evdwl += r_values[2] * constants_2b(interaction_id, start_index - 3, 14);
-    evdwl += r_values[3] * constants_2b(interaction_id, start_index - 3, 15);
+    evdwl = cubic_2b(interaction_id, start_index, 3);
+    for (int k = 2; k >= 0; k--) evdwl = evdwl * r + cubic_2b(interaction_id, start_index, k);
   }
 
-  // Calculate force
-  fpair = dnconstants_2b(interaction_id, start_index - 1, 0);
-  fpair += r_values[1] * dnconstants_2b(interaction_id, start_index - 1, 1);
-  fpair += r_values[2] * dnconstants_2b(interaction_id, start_index - 1, 2);
-  fpair += dnconstants_2b(interaction_id, start_index - 2, 3);
-  fpair += r_values[1] * dnconstants_2b(interaction_id, start_index - 2, 4);
-  fpair += r_values[2] * dnconstants_2b(interaction_id, start_index - 2, 5);
-  fpair += dnconstants_2b(interaction_id, start_index - 3, 6);
-  fpair += r_values[1] * dnconstants_2b(interaction_id, start_index - 3, 7);
-  fpair += r_values[2] * dnconstants_2b(interaction_id, start_index - 3, 8);
+  fpair = dncubic_2b(interaction_id, start_index, 2);
+  for (int k = 1; k >= 0; k--) fpair = fpair * r + dncubic_2b(interaction_id, start_index, k);
 }
 
 template <class DeviceType>
@@ -647,13 +622,15 @@ KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::threebody(
   F_FLOAT evals[3][4];
   F_FLOAT dnevals[3][4];
   int start_indices[3];
-  F_FLOAT r[3] = {value_rij, value_rik, value_rjk};
+  // i-j-k with jtype > ktype is stored as i-k-j, whose ij and ik axes are
+  // the ik and ij distances of i-j-k
+  const int swapped = (jtype > ktype) ? 1 : 0;
+  F_FLOAT r[3] = {swapped ? value_rik : value_rij, swapped ? value_rij : value_rik, value_rjk};
   int interaction_id = map3b(itype, jtype, ktype);
 
-  auto coefficients =
-      Kokkos::subview(d_coefficients_3b, interaction_id, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
-  auto dncoefficients = Kokkos::subview(d_dncoefficients_3b, interaction_id, Kokkos::ALL,
-                                        Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
+  const int coeff_offset = d_coefficients_3b_index(interaction_id, 0);
+  const int dim_ik = d_coefficients_3b_index(interaction_id, 1);
+  const int dim_jk = d_coefficients_3b_index(interaction_id, 2);
   //Notice the 2-d in d_n3b_knot_matrix
   //
   //In d_n3b_knot_matrix[i][j][k],
@@ -663,88 +640,87 @@ KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::threebody(
   //
   //and r[0] = rij, r[1] = rik and r[2] = rjk
   //see n3b_knot_matrix and pair_uf3.cpp for more details
-  for (int d = 0; d < 3; d++) {
-    start_indices[d] = 3;
-    while (r[d] > d_n3b_knot_matrix(interaction_id, 2-d, start_indices[d] + 1)) start_indices[d]++;
-    //start_indices[d] = 3+(int)((r[d]-d_n3b_knot_matrix(interaction_id, 2-d, 0))/d_n3b_knot_matrix_spacings(interaction_id, 2-d));
-
-    F_FLOAT r_values[4];
-    r_values[0] = 1;
-    r_values[1] = r[d];
-    r_values[2] = r_values[1] * r_values[1];
-
-    r_values[3] = r_values[2] * r_values[1];
-
-    // Calculate energy
-    evals[d][0] = constants_3b(interaction_id, d, start_indices[d], 0);
-    evals[d][0] += r_values[1] * constants_3b(interaction_id, d, start_indices[d], 1);
-    evals[d][0] += r_values[2] * constants_3b(interaction_id, d, start_indices[d], 2);
-    evals[d][0] += r_values[3] * constants_3b(interaction_id, d, start_indices[d], 3);
-    evals[d][1] = constants_3b(interaction_id, d, start_indices[d] - 1, 4);
-    evals[d][1] += r_values[1] * constants_3b(interaction_id, d, start_indices[d] - 1, 5);
-    evals[d][1] += r_values[2] * constants_3b(interaction_id, d, start_indices[d] - 1, 6);
-    evals[d][1] += r_values[3] * constants_3b(interaction_id, d, start_indices[d] - 1, 7);
-    evals[d][2] = constants_3b(interaction_id, d, start_indices[d] - 2, 8);
-    evals[d][2] += r_values[1] * constants_3b(interaction_id, d, start_indices[d] - 2, 9);
-    evals[d][2] += r_values[2] * constants_3b(interaction_id, d, start_indices[d] - 2, 10);
-    evals[d][2] += r_values[3] * constants_3b(interaction_id, d, start_indices[d] - 2, 11);
-    evals[d][3] = constants_3b(interaction_id, d, start_indices[d] - 3, 12);
-    evals[d][3] += r_values[1] * constants_3b(interaction_id, d, start_indices[d] - 3, 13);
-    evals[d][3] += r_values[2] * constants_3b(interaction_id, d, start_indices[d] - 3, 14);
-    evals[d][3] += r_values[3] * constants_3b(interaction_id, d, start_indices[d] - 3, 15);
-
-    dnevals[d][0] = dnconstants_3b(interaction_id, d, start_indices[d] - 1, 0);
-    dnevals[d][0] += r_values[1] * dnconstants_3b(interaction_id, d, start_indices[d] - 1, 1);
-    dnevals[d][0] += r_values[2] * dnconstants_3b(interaction_id, d, start_indices[d] - 1, 2);
-    dnevals[d][1] = dnconstants_3b(interaction_id, d, start_indices[d] - 2, 3);
-    dnevals[d][1] += r_values[1] * dnconstants_3b(interaction_id, d, start_indices[d] - 2, 4);
-    dnevals[d][1] += r_values[2] * dnconstants_3b(interaction_id, d, start_indices[d] - 2, 5);
-    dnevals[d][2] = dnconstants_3b(interaction_id, d, start_indices[d] - 3, 6);
-    dnevals[d][2] += r_values[1] * dnconstants_3b(interaction_id, d, start_indices[d] - 3, 7);
-    dnevals[d][2] += r_values[2] * dnconstants_3b(interaction_id, d, start_indices[d] - 3, 8);
-    dnevals[d][3] = 0;
-  }
-
-  if (EVFLAG) {
-    for (int i = 0; i < 4; i++) {
-      for (int j = 0; j < 4; j++) {
-        for (int k = 0; k < 4; k++) {
-          evdwl += coefficients(start_indices[0] - i, start_indices[1] - j, start_indices[2] - k) *
-              evals[0][i] * evals[1][j] * evals[2][k];
-        }
+  for (int d = 0; d < 3; d++)
+    start_indices[d] = knot_interval(
+        r[d], Kokkos::subview(d_n3b_knot_matrix, interaction_id, 2 - d, Kokkos::ALL),
+        Kokkos::subview(d_n3b_bucket, interaction_id, 2 - d, Kokkos::ALL),
+        d_n3b_lookup(interaction_id, 2 - d, 0), d_n3b_lookup(interaction_id, 2 - d, 1),
+        d_n3b_lookup_index(interaction_id, 2 - d, 0), d_n3b_lookup_index(interaction_id, 2 - d, 1),
+        d_n3b_lookup_index(interaction_id, 2 - d, 2));
+
+  // Tricubic of the knot cell in the offsets from its lower corner,
+  // nested Horner schemes along jk, ik and ij
+  const int tricubic_offset = d_tricubic_3b_index(interaction_id, 0);
+  if (tricubic_offset >= 0) {
+    const int cell = ((start_indices[0] - 3) * d_tricubic_3b_index(interaction_id, 1) +
+                      start_indices[1] - 3) * d_tricubic_3b_index(interaction_id, 2) +
+        start_indices[2] - 3;
+    const int c0 = tricubic_offset + 64 * cell;
+    const F_FLOAT u = r[0] - d_n3b_knot_matrix(interaction_id, 2, start_indices[0]);
+    const F_FLOAT v = r[1] - d_n3b_knot_matrix(interaction_id, 1, start_indices[1]);
+    const F_FLOAT w = r[2] - d_n3b_knot_matrix(interaction_id, 0, start_indices[2]);
+
+    F_FLOAT e = 0, du = 0, dv = 0, dw = 0;
+    for (int p = 3; p >= 0; p--) {
+      F_FLOAT g = 0, gv = 0, gw = 0;
+      for (int q = 3; q >= 0; q--) {
+        const int cs = c0 + 16 * p + 4 * q;
+        const F_FLOAT f = ((d_tricubic_3b(cs + 3) * w + d_tricubic_3b(cs + 2)) * w +
+                           d_tricubic_3b(cs + 1)) * w + d_tricubic_3b(cs);
+        const F_FLOAT fw = (3 * d_tricubic_3b(cs + 3) * w + 2 * d_tricubic_3b(cs + 2)) * w +
+            d_tricubic_3b(cs + 1);
+        gv = gv * v + g;
+        g = g * v + f;
+        gw = gw * v + fw;
       }
+      du = du * u + e;
+      e = e * u + g;
+      dv = dv * u + gv;
+      dw = dw * u + gw;
     }
-  }
 
-  for (int i = 0; i < 3; i++) {
-    for (int j = 0; j < 4; j++) {
-      for (int k = 0; k < 4; k++) {
-        fforce[0] += dncoefficients(0, start_indices[0] - 3 + i, start_indices[1] - 3 + j,
-                                    start_indices[2] - 3 + k) *
-            dnevals[0][2 - i] * evals[1][3 - j] * evals[2][3 - k];
-      }
-    }
+    if (EVFLAG) evdwl = e;
+    fforce[swapped] = du;
+    fforce[1 - swapped] = dv;
+    fforce[2] = dw;
+    return;
   }
 
-  for (int i = 0; i < 4; i++) {
-    for (int j = 0; j < 3; j++) {
-      for (int k = 0; k < 4; k++) {
-        fforce[1] += dncoefficients(1, start_indices[0] - 3 + i, start_indices[1] - 3 + j,
-                                    start_indices[2] - 3 + k) *
-            evals[0][3 - i] * dnevals[1][2 - j] * evals[2][3 - k];
-      }
+  // evals[d][m] is basis start_indices[d]-m at r[d], dnevals[d][m] its derivative
+  for (int d = 0; d < 3; d++) {
+    for (int m = 0; m < 4; m++) {
+      const int l = start_indices[d] - m;
+      const F_FLOAT c0 = constants_3b(interaction_id, d, l, 4 * m);
+      const F_FLOAT c1 = constants_3b(interaction_id, d, l, 4 * m + 1);
+      const F_FLOAT c2 = constants_3b(interaction_id, d, l, 4 * m + 2);
+      const F_FLOAT c3 = constants_3b(interaction_id, d, l, 4 * m + 3);
+      evals[d][m] = ((c3 * r[d] + c2) * r[d] + c1) * r[d] + c0;
+      dnevals[d][m] = (3 * c3 * r[d] + 2 * c2) * r[d] + c1;
     }
   }
 
+  // one pass over the 64 coefficients gives the energy and all derivatives
   for (int i = 0; i < 4; i++) {
     for (int j = 0; j < 4; j++) {
-      for (int k = 0; k < 3; k++) {
-        fforce[2] += dncoefficients(2, start_indices[0] - 3 + i, start_indices[1] - 3 + j,
-                                    start_indices[2] - 3 + k) *
-            evals[0][3 - i] * evals[1][3 - j] * dnevals[2][2 - k];
+      F_FLOAT sum = 0, dsum = 0;
+      for (int k = 0; k < 4; k++) {
+        const F_FLOAT c = d_coefficients_3b(
+            coeff_offset +
+            ((start_indices[0] - i) * dim_ik + start_indices[1] - j) * dim_jk + start_indices[2] - k);
+        sum += c * evals[2][k];
+        dsum += c * dnevals[2][k];
       }
+      if (EVFLAG) evdwl += evals[0][i] * evals[1][j] * sum;
+      fforce[0] += dnevals[0][i] * evals[1][j] * sum;
+      fforce[1] += evals[0][i] * dnevals[1][j] * sum;
+      fforce[2] += evals[0][i] * evals[1][j] * dsum;
     }
   }
+  if (swapped) {
+    const F_FLOAT f_ij = fforce[1];
+    fforce[1] = fforce[0];
+    fforce[0] = f_ij;
+  }
 }
 
 /* ----------------------------------------------------------------------
@@ -812,11 +788,8 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::compute(int eflag_in
   nall = atom->nlocal + atom->nghost;
   k_cutsq.template sync<DeviceType>(); //Sync the device memory of k_cutsq with
   //the array from the host memory; this updates d_cutsq also
-  k_cut_3b.template sync<DeviceType>();
-  k_min_cut_3b.template sync<DeviceType>();
   
   inum = list->inum;
-  const int ignum = inum + list->gnum;
   NeighListKokkos<DeviceType> *k_list = static_cast<NeighListKokkos<DeviceType> *>(list);
   d_ilist = k_list->d_ilist;
   d_numneigh = k_list->d_numneigh;
@@ -832,30 +805,77 @@ template <class DeviceType> void PairUF3Kokkos<DeviceType>::compute(int eflag_in
   EV_FLOAT ev;
   EV_FLOAT ev_all;
 
-  // build short neighbor list
-
-  int max_neighs = d_neighbors.extent(1);
-
-  if (((int)d_neighbors_short.extent(1) != max_neighs) || 
-          ((int)d_neighbors_short.extent(0) != ignum)) {
-    d_neighbors_short = Kokkos::View<int **, DeviceType>("UF3::neighbors_short", ignum, max_neighs);
+  // 2-body interaction over the 2-body list of my atoms
+
+  if (neighflag == HALF) {
+    if (evflag)
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<HALF, 1>>(0, inum), *this, ev);
+    else
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<HALF, 0>>(0, inum), *this);
+  } else if (neighflag == HALFTHREAD) {
+    if (evflag)
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<HALFTHREAD, 1>>(0, inum), *this,
+          ev);
+    else
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<HALFTHREAD, 0>>(0, inum), *this);
+  } else {
+    if (evflag)
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<FULL, 1>>(0, inum), *this, ev);
+    else
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeTwoBody<FULL, 0>>(0, inum), *this);
   }
-  if (d_numneigh_short.extent(0) != ignum)
-    d_numneigh_short = Kokkos::View<int *, DeviceType>("UF3::numneighs_short", ignum);
-  Kokkos::parallel_for(
-      Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeShortNeigh>(0, ignum), *this);
+  ev_all += ev;
+
+  if (pot_3b) {
+    const int inum_3b = list_3b->inum;
+    const int ignum = inum_3b + list_3b->gnum;
+    NeighListKokkos<DeviceType> *k_list_3b = static_cast<NeighListKokkos<DeviceType> *>(list_3b);
+    d_ilist_3b = k_list_3b->d_ilist;
+    d_numneigh_3b = k_list_3b->d_numneigh;
+    d_neighbors_3b = k_list_3b->d_neighbors;
+
+    // build short neighbor list. with the persist keyword it holds the
+    // candidates within the 3-body list cutoffs plus the skin and is only
+    // rebuilt with the 3-body list, the 3-body kernel filters it per step
+
+    int max_neighs = d_neighbors_3b.extent(1);
+    int rebuild_3b = !persist_3b || (neighbor->ago == 0) || !pshort_ready;
+
+    if (((int)d_neighbors_short.extent(1) != max_neighs) ||
+            ((int)d_neighbors_short.extent(0) != ignum)) {
+      d_neighbors_short = Kokkos::View<int **, DeviceType>("UF3::neighbors_short", ignum, max_neighs);
+      rebuild_3b = 1;
+    }
+    if (d_numneigh_short.extent(0) != ignum) {
+      d_numneigh_short = Kokkos::View<int *, DeviceType>("UF3::numneighs_short", ignum);
+      rebuild_3b = 1;
+    }
+    if (rebuild_3b) {
+      skin_3b = persist_3b ? neighbor->skin : 0.0;
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeShortNeigh>(0, ignum), *this);
+      pshort_ready = 1;
+    }
 
-  // loop over neighbor list of my atoms
+    // 3-body interaction over the short list of my atoms
 
-  if (evflag){
-    Kokkos::parallel_reduce(
-        Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeFullA<FULL, 1>>(0, inum), *this, ev);
-  }
-  else{
-    Kokkos::parallel_for(
-        Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeFullA<FULL, 0>>(0, inum), *this);
+    ev = EV_FLOAT();
+    if (evflag){
+      Kokkos::parallel_reduce(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeFullA<FULL, 1>>(0, inum_3b), *this, ev);
+    }
+    else{
+      Kokkos::parallel_for(
+          Kokkos::RangePolicy<DeviceType, TagPairUF3ComputeFullA<FULL, 0>>(0, inum_3b), *this);
+    }
+    ev_all += ev;
   }
-  ev_all += ev;
 
   Kokkos::Experimental::contribute(d_eatom, escatter);
   Kokkos::Experimental::contribute(d_vatom, vscatter);
@@ -898,15 +918,15 @@ template <class DeviceType>
 KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeShortNeigh,
                                                                   const int &ii) const
 {
-  const int i = d_ilist[ii];
+  const int i = d_ilist_3b[ii];
   const X_FLOAT xtmp = x(i, 0);
   const X_FLOAT ytmp = x(i, 1);
   const X_FLOAT ztmp = x(i, 2);
 
-  const int jnum = d_numneigh[i];
+  const int jnum = d_numneigh_3b[i];
   int inside = 0;
   for (int jj = 0; jj < jnum; jj++) {
-    int j = d_neighbors(i, jj);
+    int j = d_neighbors_3b(i, jj);
     j &= NEIGHMASK;
 
     const X_FLOAT delx = xtmp - x(j, 0);
@@ -917,7 +937,14 @@ KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::operator()(TagPairUF3Comp
     const int itype = type[i];
     const int jtype = type[j];
 
-    if (rsq <= d_cutsq(itype, jtype)) {
+    if (persist_3b) {
+      const F_FLOAT cutpad =
+          MIN(sqrt(d_cutsq(itype, jtype)), d_cut_3b_list(itype, jtype)) + skin_3b;
+      if (rsq <= cutpad * cutpad) {
+        d_neighbors_short(i, inside) = j;
+        inside++;
+      }
+    } else if (in_short_3b(itype, jtype, rsq)) {
       d_neighbors_short(i, inside) = j;
       inside++;
     }
@@ -930,45 +957,39 @@ KOKKOS_INLINE_FUNCTION void PairUF3Kokkos<DeviceType>::operator()(TagPairUF3Comp
 template <class DeviceType>
 template <int NEIGHFLAG, int EVFLAG>
 KOKKOS_INLINE_FUNCTION void
-PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>, const int &ii,
+PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeTwoBody<NEIGHFLAG, EVFLAG>, const int &ii,
                                       EV_FLOAT &ev) const
 {
   // The f array is duplicated for OpenMP, atomic for CUDA, and neither for Serial
 
-  auto v_f = vscatter.access();
   auto a_f = fscatter.access();
-  auto a_cvatom = cvscatter.access();
 
-  F_FLOAT del_rji[3], del_rki[3], del_rkj[3], triangle_eval[3];
-  F_FLOAT fij[3], fik[3], fjk[3];
-  F_FLOAT fji[3], fki[3], fkj[3];
-  F_FLOAT Fj[3], Fk[3];
-  F_FLOAT evdwl = 0, evdwl3 = 0;
+  // the UF3 2-body energy is a sum over ordered pairs, so each pair of
+  // a half list counts twice
+  const F_FLOAT weight = (NEIGHFLAG == FULL) ? 1.0 : 2.0;
+
+  F_FLOAT evdwl = 0;
   F_FLOAT fpair = 0;
 
   const int i = d_ilist[ii];
 
-  const tagint itag = tag[i];
   const int itype = type[i];
   const X_FLOAT xtmp = x(i, 0);
   const X_FLOAT ytmp = x(i, 1);
   const X_FLOAT ztmp = x(i, 2);
 
-  // two-body interactions
-
-  const int jnum = d_numneigh_short[i];
+  const int jnum = d_numneigh[i];
 
   F_FLOAT fxtmpi = 0.0;
   F_FLOAT fytmpi = 0.0;
   F_FLOAT fztmpi = 0.0;
 
   for (int jj = 0; jj < jnum; jj++) {
-    int j = d_neighbors_short(i, jj);
+    int j = d_neighbors(i, jj);
     j &= NEIGHMASK;
-    const tagint jtag = tag[j];
 
     const int jtype = type[j];
-    
+
     const X_FLOAT delx = xtmp - x(j, 0);
     const X_FLOAT dely = ytmp - x(j, 1);
     const X_FLOAT delz = ztmp - x(j, 2);
@@ -978,8 +999,9 @@ PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>,
 
     const F_FLOAT rij = sqrt(rsq);
     this->template twobody<EVFLAG>(itype, jtype, rij, evdwl, fpair);
-    
-    fpair = -fpair / rij;
+
+    fpair = -weight * fpair / rij;
+    evdwl *= weight;
 
     fxtmpi += delx * fpair;
     fytmpi += dely * fpair;
@@ -995,6 +1017,54 @@ PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>,
     }
   }
 
+  a_f(i, 0) += fxtmpi;
+  a_f(i, 1) += fytmpi;
+  a_f(i, 2) += fztmpi;
+}
+
+template <class DeviceType>
+template <int NEIGHFLAG, int EVFLAG>
+KOKKOS_INLINE_FUNCTION void
+PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeTwoBody<NEIGHFLAG, EVFLAG>,
+                                      const int &ii) const
+{
+  EV_FLOAT ev;
+  this->template operator()<NEIGHFLAG, EVFLAG>(TagPairUF3ComputeTwoBody<NEIGHFLAG, EVFLAG>(), ii,
+                                               ev);
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <class DeviceType>
+template <int NEIGHFLAG, int EVFLAG>
+KOKKOS_INLINE_FUNCTION void
+PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>, const int &ii,
+                                      EV_FLOAT &ev) const
+{
+  // The f array is duplicated for OpenMP, atomic for CUDA, and neither for Serial
+
+  auto a_f = fscatter.access();
+  auto a_cvatom = cvscatter.access();
+
+  F_FLOAT del_rji[3], del_rki[3], del_rkj[3], triangle_eval[3];
+  F_FLOAT fij[3], fik[3], fjk[3];
+  F_FLOAT fji[3], fki[3], fkj[3];
+  F_FLOAT Fj[3], Fk[3];
+  F_FLOAT evdwl3 = 0;
+
+  const int i = d_ilist_3b[ii];
+
+  const int itype = type[i];
+  const X_FLOAT xtmp = x(i, 0);
+  const X_FLOAT ytmp = x(i, 1);
+  const X_FLOAT ztmp = x(i, 2);
+
+  const int jnum = d_numneigh_short[i];
+
+  F_FLOAT fxtmpi = 0.0;
+  F_FLOAT fytmpi = 0.0;
+  F_FLOAT fztmpi = 0.0;
+
   // 3-body interaction
   // jth atom
   const int jnumm1 = jnum - 1;
@@ -1005,7 +1075,9 @@ PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>,
     del_rji[0] = x(j, 0) - xtmp;
     del_rji[1] = x(j, 1) - ytmp;
     del_rji[2] = x(j, 2) - ztmp;
-    F_FLOAT rij = sqrt(del_rji[0] * del_rji[0] + del_rji[1] * del_rji[1] + del_rji[2] * del_rji[2]);
+    const F_FLOAT rsqij = del_rji[0] * del_rji[0] + del_rji[1] * del_rji[1] + del_rji[2] * del_rji[2];
+    if (persist_3b && !in_short_3b(itype, jtype, rsqij)) continue;
+    F_FLOAT rij = sqrt(rsqij);
 
     F_FLOAT fxtmpj = 0.0;
     F_FLOAT fytmpj = 0.0;
@@ -1016,30 +1088,37 @@ PairUF3Kokkos<DeviceType>::operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>,
       k &= NEIGHMASK;
       const int ktype = type[k];
 
-      // Notice the order of d_min_cut_3b[i][j][k]
-      //In d_min_cut_3b[i][j][k],
-      //d_min_cut_3b[i][j][k][0] is the knot_vector along jk,
-      //d_min_cut_3b[i][j][k][1] is the knot_vector along ik,
-      //d_min_cut_3b[i][j][k][2] is the knot_vector along ij,
+      // no 3-body term for i-j-k
+      const int id = map3b(itype, jtype, ktype);
+      if (id < 0) continue;
+
+      // Notice the order of d_min_cut_3b and d_cut_3b
+      //d_min_cut_3b(id, 0..2) are the first knots along jk, ik and ij,
+      //d_cut_3b(id, 0..2) the cutoffs, both of i-j-k with jtype <= ktype.
+      //For jtype > ktype the ik and ij entries are swapped
       //see pair_uf3.cpp for more details
-      if (rij < d_min_cut_3b(itype, jtype, ktype, 2)) continue;
-      if (rij > d_cut_3b(itype, jtype, ktype)) continue;
+      const int sw = (jtype > ktype) ? 1 : 0;
+      if (rij < d_min_cut_3b(id, 2 - sw)) continue;
+      if (rij > d_cut_3b(id, 2 - sw)) continue;
 
       del_rki[0] = x(k, 0) - xtmp;
       del_rki[1] = x(k, 1) - ytmp;
       del_rki[2] = x(k, 2) - ztmp;
-      F_FLOAT rik =
-          sqrt(del_rki[0] * del_rki[0] + del_rki[1] * del_rki[1] + del_rki[2] * del_rki[2]);
+      const F_FLOAT rsqik =
+          del_rki[0] * del_rki[0] + del_rki[1] * del_rki[1] + del_rki[2] * del_rki[2];
+      if (persist_3b && !in_short_3b(itype, ktype, rsqik)) continue;
+      F_FLOAT rik = sqrt(rsqik);
 
-      if (rik < d_min_cut_3b(itype, jtype, ktype, 1)) continue;
-      if (rik > d_cut_3b(itype, ktype, jtype)) continue;
+      if (rik < d_min_cut_3b(id, 1 + sw)) continue;
+      if (rik > d_cut_3b(id, 1 + sw)) continue;
 
       del_rkj[0] = x(k, 0) - x(j, 0);
       del_rkj[1] = x(k, 1) - x(j, 1);
       del_rkj[2] = x(k, 2) - x(j, 2);
       F_FLOAT rjk =
           sqrt(del_rkj[0] * del_rkj[0] + del_rkj[1] * del_rkj[1] + del_rkj[2] * del_rkj[2]);
-      if (rjk < d_min_cut_3b(itype, jtype, ktype, 0)) continue;
+      if (rjk < d_min_cut_3b(id, 0)) continue;
+      if (rjk > d_cut_3b(id, 0)) continue;
       this->template threebody<EVFLAG>(itype, jtype, ktype, rij, rik, rjk, evdwl3, triangle_eval);
 
       fij[0] = *(triangle_eval + 0) * (del_rji[0] / rij);
@@ -1671,44 +1750,19 @@ double PairUF3Kokkos<DeviceType>::single(int /*i*/, int /*j*/, int itype, int jt
   double value = 0.0;
   double r = sqrt(rsq);
   int interaction_id = map2b(itype, jtype);
-  int start_index = 3;
-  while (r > d_n2b_knot(interaction_id, start_index + 1)) start_index++;
+  const int start_index = knot_interval(
+      r, Kokkos::subview(d_n2b_knot, interaction_id, Kokkos::ALL),
+      Kokkos::subview(d_n2b_bucket, interaction_id, Kokkos::ALL),
+      d_n2b_lookup(interaction_id, 0), d_n2b_lookup(interaction_id, 1),
+      d_n2b_lookup_index(interaction_id, 0), d_n2b_lookup_index(interaction_id, 1),
+      d_n2b_lookup_index(interaction_id, 2));
 
   if (r < d_cutsq(itype, jtype)) {
-    F_FLOAT r_values[4];
-    r_values[0] = 1;
-    r_values[1] = r;
-    r_values[2] = r_values[1] * r_values[1];
-    r_values[3] = r_values[2] * r_values[1];
-
-    // Calculate energy
-    value = constants_2b(interaction_id, start_index, 0);
-    value += r_values[1] * constants_2b(interaction_id, start_index, 1);
-    value += r_values[2] * constants_2b(interaction_id, start_index, 2);
-    value += r_values[3] * constants_2b(interaction_id, start_index, 3);
-    value += constants_2b(interaction_id, start_index - 1, 4);
-    value += r_values[1] * constants_2b(interaction_id, start_index - 1, 5);
-    value += r_values[2] * constants_2b(interaction_id, start_index - 1, 6);
-    value += r_values[3] * constants_2b(interaction_id, start_index - 1, 7);
-    value += constants_2b(interaction_id, start_index - 2, 8);
-    value += r_values[1] * constants_2b(interaction_id, start_index - 2, 9);
-    value += r_values[2] * constants_2b(interaction_id, start_index - 2, 10);
-    value += r_values[3] * constants_2b(interaction_id, start_index - 2, 11);
-    value += constants_2b(interaction_id, start_index - 3, 12);
-    value += r_values[1] * constants_2b(interaction_id, start_index - 3, 13);
-    value += r_values[2] * constants_2b(interaction_id, start_index - 3, 14);
-    value += r_values[3] * constants_2b(interaction_id, start_index - 3, 15);
-
-    // Calculate force
-    fforce = dnconstants_2b(interaction_id, start_index - 1, 0);
-    fforce += r_values[1] * dnconstants_2b(interaction_id, start_index - 1, 1);
-    fforce += r_values[2] * dnconstants_2b(interaction_id, start_index - 1, 2);
-    fforce += dnconstants_2b(interaction_id, start_index - 2, 3);
-    fforce += r_values[1] * dnconstants_2b(interaction_id, start_index - 2, 4);
-    fforce += r_values[2] * dnconstants_2b(interaction_id, start_index - 2, 5);
-    fforce += dnconstants_2b(interaction_id, start_index - 3, 6);
-    fforce += r_values[1] * dnconstants_2b(interaction_id, start_index - 3, 7);
-    fforce += r_values[2] * dnconstants_2b(interaction_id, start_index - 3, 8);
+    value = cubic_2b(interaction_id, start_index, 3);
+    for (int k = 2; k >= 0; k--) value = value * r + cubic_2b(interaction_id, start_index, k);
+
+    fforce = dncubic_2b(interaction_id, start_index, 2);
+    for (int k = 1; k >= 0; k--) fforce = fforce * r + dncubic_2b(interaction_id, start_index, k);
   }
 
   return factor_lj * value;
@@ -31,6 +31,7 @@ PairStyle(uf3/kk/device,PairUF3Kokkos<LMPDeviceType>)
 #include "pair_kokkos.h"
 #include "pair_uf3.h"
 
+template <int NEIGHFLAG, int EVFLAG> struct TagPairUF3ComputeTwoBody {};
 template <int NEIGHFLAG, int EVFLAG> struct TagPairUF3ComputeFullA {};
 struct TagPairUF3ComputeShortNeigh {};
 
@@ -45,13 +46,21 @@ template <class DeviceType> class PairUF3Kokkos : public PairUF3 {
   void coeff(int, char **) override;
   void allocate();
   void init_style() override;
-  void init_list(int, class NeighList *) override;    // needed for ptr to full neigh list
+  void init_list(int, class NeighList *) override;    // needed for ptrs to the two neigh lists
   double init_one(int, int) override;                 // needed for cutoff radius for neighbour list
   double single(int, int, int, int, double, double, double, double &) override;
 
   template <typename T, typename V> void copy_2d(V &d, T **h, int m, int n);
   template <typename T, typename V> void copy_3d(V &d, T ***h, int m, int n, int o);
 
+  template <int NEIGHFLAG, int EVFLAG>
+  KOKKOS_INLINE_FUNCTION void operator()(TagPairUF3ComputeTwoBody<NEIGHFLAG, EVFLAG>, const int &,
+                                         EV_FLOAT &) const;
+
+  template <int NEIGHFLAG, int EVFLAG>
+  KOKKOS_INLINE_FUNCTION void operator()(TagPairUF3ComputeTwoBody<NEIGHFLAG, EVFLAG>,
+                                         const int &) const;
+
   template <int NEIGHFLAG, int EVFLAG>
   KOKKOS_INLINE_FUNCTION void operator()(TagPairUF3ComputeFullA<NEIGHFLAG, EVFLAG>, const int &,
                                          EV_FLOAT &) const;
@@ -63,7 +72,15 @@ template <class DeviceType> class PairUF3Kokkos : public PairUF3 {
   KOKKOS_INLINE_FUNCTION
   void operator()(TagPairUF3ComputeShortNeigh, const int &) const;
 
-  enum { EnabledNeighFlags = FULL };
+  // the filter of the short neighbor list without the persist keyword
+  KOKKOS_INLINE_FUNCTION
+  bool in_short_3b(const int itype, const int jtype, const F_FLOAT rsq) const
+  {
+    return (rsq < d_cutsq(itype, jtype)) &&
+        (rsq <= d_cut_3b_list(itype, jtype) * d_cut_3b_list(itype, jtype));
+  }
+
+  enum { EnabledNeighFlags = FULL | HALF | HALFTHREAD };
   enum { COUL_FLAG = 0 };
   typedef DeviceType device_type;
   typedef ArrayTypes<DeviceType> AT;
@@ -75,35 +92,41 @@ template <class DeviceType> class PairUF3Kokkos : public PairUF3 {
   //the type of d_cutsq is decided by the Device(not host) type for the DualView k_cutsq
   //Meaning the memory location of d_cutsq is the same as the Device(not host) memory location of
   //k_cutsq
-  typedef Kokkos::DualView<F_FLOAT***, Kokkos::LayoutRight, DeviceType> tdual_ffloat_3d;
-  typedef Kokkos::DualView<F_FLOAT****, Kokkos::LayoutRight, DeviceType> tdual_ffloat_4d;
-  tdual_ffloat_3d k_cut_3b;
-  tdual_ffloat_4d k_min_cut_3b;
-  typename tdual_ffloat_3d::t_dev d_cut_3b;
-  typename tdual_ffloat_4d::t_dev d_min_cut_3b;
-  template <typename TYPE> void destroy_3d(TYPE data, typename TYPE::value_type*** &array);
-  template <typename TYPE> void destroy_4d(TYPE data, typename TYPE::value_type**** &array);
+  // cutoffs and first knots of every 3-body interaction, ordered jk, ik, ij
+  Kokkos::View<F_FLOAT *[3], LMPDeviceType::array_layout, LMPDeviceType> d_cut_3b, d_min_cut_3b;
   Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> /*d_cutsq,*/ d_cut_3b_list;
   //Kokkos::View<F_FLOAT ***, LMPDeviceType::array_layout, LMPDeviceType> d_cut_3b;
 
-  Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> d_coefficients_2b;
-  Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> d_dncoefficients_2b;
   Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> d_n2b_knot;
-  Kokkos::View<F_FLOAT *, LMPDeviceType::array_layout, LMPDeviceType> d_n2b_knot_spacings;
   Kokkos::View<int **, LMPDeviceType::array_layout, LMPDeviceType> map2b;
   Kokkos::View<F_FLOAT[4][4], LMPDeviceType::array_layout, LMPDeviceType> constants;
   Kokkos::View<F_FLOAT[3][3], LMPDeviceType::array_layout, LMPDeviceType> dnconstants;
   Kokkos::View<F_FLOAT ***, LMPDeviceType::array_layout, LMPDeviceType> d_n3b_knot_matrix;
-  Kokkos::View<F_FLOAT ****, LMPDeviceType::array_layout, LMPDeviceType> d_coefficients_3b;
-  Kokkos::View<F_FLOAT *****, LMPDeviceType::array_layout, LMPDeviceType> d_dncoefficients_3b;
-  Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> d_n3b_knot_spacings;
-  Kokkos::View<F_FLOAT **, LMPDeviceType::array_layout, LMPDeviceType> d_n3b_knot_matrix_spacings;
+  // 3-body coefficient tensors one after the other, d_coefficients_3b_index
+  // holds the offset and the ik and jk dimensions of every tensor
+  Kokkos::View<F_FLOAT *, LMPDeviceType::array_layout, LMPDeviceType> d_coefficients_3b;
+  Kokkos::View<int *[3], LMPDeviceType::array_layout, LMPDeviceType> d_coefficients_3b_index;
+  // map3b(i, j, k) == map3b(i, k, j), the interaction is stored for j <= k,
+  // -1 for triplets without 3-body term
   Kokkos::View<int ***, LMPDeviceType::array_layout, LMPDeviceType> map3b;
 
-  Kokkos::View<F_FLOAT **[16], LMPDeviceType::array_layout, LMPDeviceType> constants_2b;
-  Kokkos::View<F_FLOAT **[9], LMPDeviceType::array_layout, LMPDeviceType> dnconstants_2b;
+  // knot interval lookup of every knot vector, see uf3_interval_table:
+  // start and inverse width of the uniform knots or of the buckets, and
+  // uniform, number of buckets and number of intervals
+  Kokkos::View<F_FLOAT *[2], LMPDeviceType::array_layout, LMPDeviceType> d_n2b_lookup;
+  Kokkos::View<int *[3], LMPDeviceType::array_layout, LMPDeviceType> d_n2b_lookup_index;
+  Kokkos::View<int **, LMPDeviceType::array_layout, LMPDeviceType> d_n2b_bucket;
+  Kokkos::View<F_FLOAT **[2], LMPDeviceType::array_layout, LMPDeviceType> d_n3b_lookup;
+  Kokkos::View<int **[3], LMPDeviceType::array_layout, LMPDeviceType> d_n3b_lookup_index;
+  Kokkos::View<int ***, LMPDeviceType::array_layout, LMPDeviceType> d_n3b_bucket;
+
+  Kokkos::View<F_FLOAT **[4], LMPDeviceType::array_layout, LMPDeviceType> cubic_2b;
+  Kokkos::View<F_FLOAT **[3], LMPDeviceType::array_layout, LMPDeviceType> dncubic_2b;
   Kokkos::View<F_FLOAT ***[16], LMPDeviceType::array_layout, LMPDeviceType> constants_3b;
-  Kokkos::View<F_FLOAT ***[9], LMPDeviceType::array_layout, LMPDeviceType> dnconstants_3b;
+  // per knot cell tricubics of the interactions selected with 'tricubic',
+  // d_tricubic_3b_index holds the offset (-1 if unused), nint_ik and nint_jk
+  Kokkos::View<F_FLOAT *, LMPDeviceType::array_layout, LMPDeviceType> d_tricubic_3b;
+  Kokkos::View<int *[3], LMPDeviceType::array_layout, LMPDeviceType> d_tricubic_3b_index;
 
   std::vector<F_FLOAT> get_constants(double *knots, double coefficient);
   std::vector<F_FLOAT> get_dnconstants(double *knots, double coefficient);
@@ -114,6 +137,14 @@ template <class DeviceType> class PairUF3Kokkos : public PairUF3 {
   void create_2b_coefficients();
   std::vector<F_FLOAT> get_coefficients(const double *knots, const double coefficient) const;
   std::vector<F_FLOAT> get_dncoefficients(const double *knots, const double coefficient) const;
+  static void knot_lookup(const std::vector<double> &knots, int spacing_type, double *lookup,
+                          int *lookup_index, std::vector<int> &bucket);
+
+  template <class KnotView, class BucketView>
+  KOKKOS_INLINE_FUNCTION static int
+  knot_interval(const F_FLOAT r, const KnotView &knots, const BucketView &bucket,
+                const F_FLOAT start, const F_FLOAT inv, const int uniform, const int nbucket,
+                const int nint);
 
   template <int EVFLAG>
   void twobody(const int itype, const int jtype, const F_FLOAT r, F_FLOAT &evdwl,
@@ -156,16 +187,23 @@ template <class DeviceType> class PairUF3Kokkos : public PairUF3 {
                                                          typename DeviceType::memory_space>;
   ScatterEType escatter;
 
+  // 2-body list, full or half depending on the neighbor flag
   typename AT::t_neighbors_2d d_neighbors;
   typename AT::t_int_1d_randomread d_ilist;
   typename AT::t_int_1d_randomread d_numneigh;
 
+  // full list with ghosts at the 3-body cutoffs
+  typename AT::t_neighbors_2d d_neighbors_3b;
+  typename AT::t_int_1d_randomread d_ilist_3b;
+  typename AT::t_int_1d_randomread d_numneigh_3b;
+
   int neighflag, newton_pair;
   int nlocal, nall, eflag, vflag;
 
   int inum;
   Kokkos::View<int **, DeviceType> d_neighbors_short;
   Kokkos::View<int *, DeviceType> d_numneigh_short;
+  F_FLOAT skin_3b;    // padding of the short neighbor list with the persist keyword
 
   friend void pair_virial_fdotr_compute<PairUF3Kokkos>(PairUF3Kokkos *);
 };
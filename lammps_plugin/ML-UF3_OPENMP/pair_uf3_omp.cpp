@@ -0,0 +1,560 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida),
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#include "pair_uf3_omp.h"
+
+#include "atom.h"
+#include "comm.h"
+#include "force.h"
+#include "math_const.h"
+#include "memory.h"
+#include "neigh_list.h"
+#include "neighbor.h"
+#include "suffix.h"
+
+#include <cmath>
+#include <vector>
+
+#if defined(_OPENMP)
+#include <omp.h>
+#endif
+
+#include "omp_compat.h"
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+// number of ilist chunks handed out per thread by the dynamic schedule
+static constexpr int CHUNKS_PER_THREAD = 8;
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3OMP::PairUF3OMP(LAMMPS *lmp) : PairUF3(lmp), ThrOMP(lmp, THR_PAIR)
+{
+  suffix_flag |= Suffix::OMP;
+  respa_enable = 0;
+  chunk_start = nullptr;
+  nchunk = maxchunk = 0;
+  numshort_ii = nullptr;
+  maxnumshort_ii = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3OMP::~PairUF3OMP()
+{
+  memory->destroy(chunk_start);
+  memory->destroy(numshort_ii);
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairUF3OMP::compute(int eflag, int vflag)
+{
+  ev_init(eflag, vflag);
+
+  const int nall = atom->nlocal + atom->nghost;
+  const int nthreads = comm->nthreads;
+
+  setup_chunks(nthreads);
+
+  // candidates of the 3-body loop with the persist keyword, see PairUF3
+  const int rebuild_3b = pot_3b && persist_3b && ((neighbor->ago == 0) || !pshort_ready);
+  if (rebuild_3b) setup_candidates_3b();
+
+#if defined(_OPENMP)
+#pragma omp parallel LMP_DEFAULT_NONE LMP_SHARED(eflag, vflag, rebuild_3b)
+#endif
+  {
+#if defined(_OPENMP)
+    const int tid = omp_get_thread_num();
+#else
+    const int tid = 0;
+#endif
+
+    ThrData *thr = fix->get_thr(tid);
+    thr->timer(Timer::START);
+    ev_setup_thr(eflag, vflag, nall, eatom, vatom, cvatom, thr);
+
+    // thread private type grouped short neighbor list for the 3-body loop,
+    // its per neighbor cache and the slabs of the factorized evaluation
+
+    ShortListThr sthr;
+    sthr.maxshort = maxshort;
+    memory->create(sthr.neighshort, sthr.maxshort, "pair_thr:neighshort_thr");
+    memory->create(sthr.rshort, sthr.maxshort, "pair_thr:rshort_thr");
+    memory->create(sthr.delshort, sthr.maxshort, 3, "pair_thr:delshort_thr");
+    memory->create(sthr.ushort, sthr.maxshort, 3, "pair_thr:ushort_thr");
+    memory->create(sthr.ikshort, sthr.maxshort, "pair_thr:ikshort_thr");
+    sthr.short_start.resize(num_of_elements + 2);
+    sthr.ikshort_jtype.resize(num_of_elements + 1);
+    sthr.slab.resize(num_of_elements + 1);
+    sthr.slab_state.resize(num_of_elements + 1);
+
+#if defined(_OPENMP)
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (int n = 0; n < nchunk; n++) {
+      if (evflag) {
+        if (eflag) {
+          eval<1, 1>(chunk_start[n], chunk_start[n + 1], rebuild_3b, sthr, thr);
+        } else {
+          eval<1, 0>(chunk_start[n], chunk_start[n + 1], rebuild_3b, sthr, thr);
+        }
+      } else {
+        eval<0, 0>(chunk_start[n], chunk_start[n + 1], rebuild_3b, sthr, thr);
+      }
+    }
+
+    memory->destroy(sthr.neighshort);
+    memory->destroy(sthr.rshort);
+    memory->destroy(sthr.delshort);
+    memory->destroy(sthr.ushort);
+    memory->destroy(sthr.ikshort);
+
+    thr->timer(Timer::PAIR);
+    reduce_thr(this, eflag, vflag, thr);
+  }    // end of omp parallel region
+}
+
+/* ----------------------------------------------------------------------
+   split ilist into chunks of roughly equal work for the dynamic schedule.
+   an atom costs its 2-body half list neighbors plus the number of neighbor
+   pairs visited by the triplet loop. the short list sizes of the previous
+   step are used when the neighbor lists are unchanged, after reneighboring
+   the size of the 3-body full list is taken as an estimate. both lists
+   hold the local atoms in the same order.
+------------------------------------------------------------------------- */
+
+void PairUF3OMP::setup_chunks(int nthreads)
+{
+  const int inum = list->inum;
+  const int *const ilist = list->ilist;
+  const int *const numneigh = list->numneigh;
+
+  int estimate = (neighbor->ago == 0);
+  if (inum > maxnumshort_ii) {
+    maxnumshort_ii = atom->nmax;
+    memory->destroy(numshort_ii);
+    memory->create(numshort_ii, maxnumshort_ii, "pair:numshort_ii");
+    estimate = 1;
+  }
+  if (estimate && pot_3b) {
+    const int *const numneigh_3b = list_3b->numneigh;
+    for (int ii = 0; ii < inum; ii++) numshort_ii[ii] = numneigh_3b[list_3b->ilist[ii]];
+  }
+
+  double total = 0.0;
+  for (int ii = 0; ii < inum; ii++) {
+    const double nshort = pot_3b ? numshort_ii[ii] : 0.0;
+    total += numneigh[ilist[ii]] + 0.5 * nshort * (nshort - 1.0);
+  }
+
+  int target = (nthreads > 1) ? CHUNKS_PER_THREAD * nthreads : 1;
+  target = MAX(MIN(target, inum), 1);
+  if (target + 1 > maxchunk) {
+    maxchunk = target + 1;
+    memory->destroy(chunk_start);
+    memory->create(chunk_start, maxchunk, "pair:chunk_start");
+  }
+
+  const double chunk_cost = total / target;
+  double cost = 0.0;
+  nchunk = 0;
+  chunk_start[0] = 0;
+  for (int ii = 0; ii < inum - 1 && nchunk < target - 1; ii++) {
+    const double nshort = pot_3b ? numshort_ii[ii] : 0.0;
+    cost += numneigh[ilist[ii]] + 0.5 * nshort * (nshort - 1.0);
+    if (cost >= (nchunk + 1) * chunk_cost) chunk_start[++nchunk] = ii + 1;
+  }
+  chunk_start[++nchunk] = inum;
+}
+
+/* ---------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG>
+void PairUF3OMP::eval(int iifrom, int iito, int rebuild_3b, ShortListThr &sthr,
+                      ThrData *const thr)
+{
+  int i, j, k, ii, jj, kk, jnum, itype, jtype, ktype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, evdwl, fpair, fx, fy, fz;
+  double *del_rji, *del_rki, del_rkj[3];
+  double fij[3], fik[3], fjk[3];
+  double fji[3], fki[3], fkj[3];
+  double Fi[3], Fj[3], Fk[3];
+  double rsq, rij, rik, rjk;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+
+  const dbl3_t *_noalias const x = (dbl3_t *) atom->x[0];
+  dbl3_t *_noalias const f = (dbl3_t *) thr->get_f()[0];
+  double **const cvatom_thr = thr->cvatom_pair;
+  const int *_noalias const type = atom->type;
+  const int nlocal = atom->nlocal;
+  const int newton_pair = force->newton_pair;
+
+  int *&neighshort_thr = sthr.neighshort;
+  double *&rshort_thr = sthr.rshort;
+  double **&delshort_thr = sthr.delshort;
+  double **&ushort_thr = sthr.ushort;
+  uf3_axis_bases *&ikshort_thr = sthr.ikshort;
+  int &maxshort_thr = sthr.maxshort;
+  std::vector<int> &short_start_thr = sthr.short_start;
+  std::vector<int> &ikshort_jtype_thr = sthr.ikshort_jtype;
+
+  // 2-body interaction over the half list, each pair counts twice
+
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over neighbors of my atoms
+  for (ii = iifrom; ii < iito; ii++) {
+    evdwl = 0;
+    i = ilist[ii];
+    xtmp = x[i].x;
+    ytmp = x[i].y;
+    ztmp = x[i].z;
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j].x;
+      dely = ytmp - x[j].y;
+      delz = ztmp - x[j].z;
+
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      if (rsq < cutsq[itype][jtype]) {
+        rij = sqrt(rsq);
+
+        double pair_eval[2];
+        UFBS2b[itype][jtype]->eval(rij, pair_eval);
+
+        fpair = -2 * pair_eval[1] / rij;
+
+        fx = delx * fpair;
+        fy = dely * fpair;
+        fz = delz * fpair;
+
+        f[i].x += fx;
+        f[i].y += fy;
+        f[i].z += fz;
+        f[j].x -= fx;
+        f[j].y -= fy;
+        f[j].z -= fz;
+
+        if (EFLAG) evdwl = 2 * pair_eval[0];
+
+        if (EVFLAG) {
+          ev_tally_xyz_thr(this, i, j, nlocal, newton_pair, evdwl, 0.0, fx, fy, fz, delx, dely,
+                           delz, thr);
+
+          // Centroid Stress
+          if (vflag_either && cvflag_atom) {
+            double v[6];
+
+            v[0] = delx * fx;
+            v[1] = dely * fy;
+            v[2] = delz * fz;
+            v[3] = delx * fy;
+            v[4] = delx * fz;
+            v[5] = dely * fz;
+
+            cvatom_thr[i][0] += 0.5 * v[0];
+            cvatom_thr[i][1] += 0.5 * v[1];
+            cvatom_thr[i][2] += 0.5 * v[2];
+            cvatom_thr[i][3] += 0.5 * v[3];
+            cvatom_thr[i][4] += 0.5 * v[4];
+            cvatom_thr[i][5] += 0.5 * v[5];
+            cvatom_thr[i][6] += 0.5 * v[3];
+            cvatom_thr[i][7] += 0.5 * v[4];
+            cvatom_thr[i][8] += 0.5 * v[5];
+
+            cvatom_thr[j][0] += 0.5 * v[0];
+            cvatom_thr[j][1] += 0.5 * v[1];
+            cvatom_thr[j][2] += 0.5 * v[2];
+            cvatom_thr[j][3] += 0.5 * v[3];
+            cvatom_thr[j][4] += 0.5 * v[4];
+            cvatom_thr[j][5] += 0.5 * v[5];
+            cvatom_thr[j][6] += 0.5 * v[3];
+            cvatom_thr[j][7] += 0.5 * v[4];
+            cvatom_thr[j][8] += 0.5 * v[5];
+          }
+        }
+      }
+    }
+  }
+
+  if (!pot_3b) return;
+
+  // 3-body interaction over the full list at the 3-body cutoffs
+
+  ilist = list_3b->ilist;
+  numneigh = list_3b->numneigh;
+  firstneigh = list_3b->firstneigh;
+
+  for (ii = iifrom; ii < iito; ii++) {
+    evdwl = 0;
+    i = ilist[ii];
+    xtmp = x[i].x;
+    ytmp = x[i].y;
+    ztmp = x[i].z;
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (persist_3b) {
+      if (rebuild_3b)
+        pshort_num[ii] =
+            collect_candidates_3b(i, jlist, jnum, pshort + pshort_start[ii], sthr.rcand);
+      jlist = pshort + pshort_start[ii];
+      jnum = pshort_num[ii];
+    }
+
+    // short list grouped by type and sorted by distance, see PairUF3::compute()
+    int numshort = 0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j].x;
+      dely = ytmp - x[j].y;
+      delz = ztmp - x[j].z;
+
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      if (rsq < cutsq[itype][jtype]) {
+        rij = sqrt(rsq);
+        if (rij > cut_3b_list[itype][jtype]) continue;
+        int n = numshort;
+        while ((n > 0) &&
+               ((type[neighshort_thr[n - 1]] > jtype) ||
+                ((type[neighshort_thr[n - 1]] == jtype) && (rshort_thr[n - 1] > rij)))) {
+          neighshort_thr[n] = neighshort_thr[n - 1];
+          rshort_thr[n] = rshort_thr[n - 1];
+          n--;
+        }
+        neighshort_thr[n] = j;
+        rshort_thr[n] = rij;
+        if (numshort >= maxshort_thr - 1) {
+          maxshort_thr += maxshort_thr / 2;
+          memory->grow(neighshort_thr, maxshort_thr, "pair:neighshort_thr");
+          memory->grow(rshort_thr, maxshort_thr, "pair:rshort_thr");
+          memory->grow(delshort_thr, maxshort_thr, 3, "pair:delshort_thr");
+          memory->grow(ushort_thr, maxshort_thr, 3, "pair:ushort_thr");
+          memory->grow(ikshort_thr, maxshort_thr, "pair:ikshort_thr");
+        }
+        numshort = numshort + 1;
+      }
+    }
+
+    // remember the work of this atom for load balancing the next step
+    numshort_ii[ii] = numshort;
+
+    // start of the ktype group in the short list
+    int n = 0;
+    for (ktype = 1; ktype < num_of_elements + 2; ktype++) {
+      while ((n < numshort) && (type[neighshort_thr[n]] < ktype)) n++;
+      short_start_thr[ktype] = n;
+    }
+
+    // per neighbor cache, see PairUF3::compute()
+    for (n = 0; n < numshort; n++) {
+      j = neighshort_thr[n];
+      delshort_thr[n][0] = x[j].x - xtmp;
+      delshort_thr[n][1] = x[j].y - ytmp;
+      delshort_thr[n][2] = x[j].z - ztmp;
+      ushort_thr[n][0] = delshort_thr[n][0] / rshort_thr[n];
+      ushort_thr[n][1] = delshort_thr[n][1] / rshort_thr[n];
+      ushort_thr[n][2] = delshort_thr[n][2] / rshort_thr[n];
+    }
+    for (ktype = 1; ktype < num_of_elements + 1; ktype++) ikshort_jtype_thr[ktype] = 0;
+
+    // 3-body interaction
+    // jth atom
+    const int numshort_1 = numshort - 1;
+    for (jj = 0; jj < numshort_1; jj++) {
+      j = neighshort_thr[jj];
+      jtype = type[j];
+      rij = rshort_thr[jj];
+      del_rji = delshort_thr[jj];
+
+      // kth atoms, one ktype group at a time
+      for (ktype = jtype; ktype < num_of_elements + 1; ktype++) {
+        const int id = id_3b(itype, jtype, ktype);
+        const uf3_interaction_3b &inter = interactions_3b[id];
+        if ((rij > inter.cut[2]) || (rij < inter.min_cut[2])) continue;
+
+        uf3_triplet_bspline &bspline_3b = bsplines_3b[id];
+        const double cut_ik = inter.cut[1];
+        const double min_ik = inter.min_cut[1];
+        const double min_jk = inter.min_cut[0];
+        const double cut_jk = inter.cut[0];
+        uf3_axis_bases bases_ij;
+        bspline_3b.bases_ij(rij, bases_ij);
+
+        const int kbegin = (ktype == jtype) ? jj + 1 : short_start_thr[ktype];
+        int kend = short_start_thr[ktype + 1];
+        while ((kend > kbegin) && (rshort_thr[kend - 1] > cut_ik)) kend--;
+        int kfirst = kbegin, klast = kend;
+        while ((kfirst < klast) && (rshort_thr[kfirst] < rij - cut_jk)) kfirst++;
+        while ((klast > kfirst) && (rshort_thr[klast - 1] > rij + cut_jk)) klast--;
+
+        if (ikshort_jtype_thr[ktype] != jtype) {
+          for (kk = short_start_thr[ktype]; kk < kend; kk++)
+            bspline_3b.bases_ik(rshort_thr[kk], ikshort_thr[kk]);
+          ikshort_jtype_thr[ktype] = jtype;
+        }
+
+        // the ij contraction of the previous j is stale
+        sthr.slab_state[ktype] = 0;
+
+        for (kk = kfirst; kk < klast; kk++) {
+          k = neighshort_thr[kk];
+          rik = rshort_thr[kk];
+
+          if (rik >= min_ik) {
+            del_rki = delshort_thr[kk];
+
+            del_rkj[0] = del_rki[0] - del_rji[0];
+            del_rkj[1] = del_rki[1] - del_rji[1];
+            del_rkj[2] = del_rki[2] - del_rji[2];
+            rjk = sqrt(((del_rkj[0] * del_rkj[0]) + (del_rkj[1] * del_rkj[1]) +
+                        (del_rkj[2] * del_rkj[2])));
+
+            if ((rjk >= min_jk) && (rjk <= cut_jk)) {
+              double triangle_eval[4];
+              bspline_3b.eval_factorized(bases_ij, ikshort_thr[kk], rjk, klast - kk,
+                                         sthr.slab[ktype], sthr.slab_state[ktype], triangle_eval);
+
+              fij[0] = triangle_eval[1] * ushort_thr[jj][0];
+              fji[0] = -fij[0];
+              fik[0] = triangle_eval[2] * ushort_thr[kk][0];
+              fki[0] = -fik[0];
+              fjk[0] = triangle_eval[3] * (del_rkj[0] / rjk);
+              fkj[0] = -fjk[0];
+
+              fij[1] = triangle_eval[1] * ushort_thr[jj][1];
+              fji[1] = -fij[1];
+              fik[1] = triangle_eval[2] * ushort_thr[kk][1];
+              fki[1] = -fik[1];
+              fjk[1] = triangle_eval[3] * (del_rkj[1] / rjk);
+              fkj[1] = -fjk[1];
+
+              fij[2] = triangle_eval[1] * ushort_thr[jj][2];
+              fji[2] = -fij[2];
+              fik[2] = triangle_eval[2] * ushort_thr[kk][2];
+              fki[2] = -fik[2];
+              fjk[2] = triangle_eval[3] * (del_rkj[2] / rjk);
+              fkj[2] = -fjk[2];
+
+              Fi[0] = fij[0] + fik[0];
+              Fi[1] = fij[1] + fik[1];
+              Fi[2] = fij[2] + fik[2];
+              f[i].x += Fi[0];
+              f[i].y += Fi[1];
+              f[i].z += Fi[2];
+
+              Fj[0] = fji[0] + fjk[0];
+              Fj[1] = fji[1] + fjk[1];
+              Fj[2] = fji[2] + fjk[2];
+              f[j].x += Fj[0];
+              f[j].y += Fj[1];
+              f[j].z += Fj[2];
+
+              Fk[0] = fki[0] + fkj[0];
+              Fk[1] = fki[1] + fkj[1];
+              Fk[2] = fki[2] + fkj[2];
+              f[k].x += Fk[0];
+              f[k].y += Fk[1];
+              f[k].z += Fk[2];
+
+              if (EFLAG) evdwl = triangle_eval[0];
+
+              if (EVFLAG) {
+                ev_tally3_thr(this, i, j, k, evdwl, 0, Fj, Fk, del_rji, del_rki, thr);
+
+                // Centroid stress 3-body term
+                if (vflag_either && cvflag_atom) {
+                  double ric[3];
+                  ric[0] = THIRD * (-del_rji[0] - del_rki[0]);
+                  ric[1] = THIRD * (-del_rji[1] - del_rki[1]);
+                  ric[2] = THIRD * (-del_rji[2] - del_rki[2]);
+
+                  cvatom_thr[i][0] += ric[0] * Fi[0];
+                  cvatom_thr[i][1] += ric[1] * Fi[1];
+                  cvatom_thr[i][2] += ric[2] * Fi[2];
+                  cvatom_thr[i][3] += ric[0] * Fi[1];
+                  cvatom_thr[i][4] += ric[0] * Fi[2];
+                  cvatom_thr[i][5] += ric[1] * Fi[2];
+                  cvatom_thr[i][6] += ric[1] * Fi[0];
+                  cvatom_thr[i][7] += ric[2] * Fi[0];
+                  cvatom_thr[i][8] += ric[2] * Fi[1];
+
+                  double rjc[3];
+                  rjc[0] = THIRD * (del_rji[0] - del_rkj[0]);
+                  rjc[1] = THIRD * (del_rji[1] - del_rkj[1]);
+                  rjc[2] = THIRD * (del_rji[2] - del_rkj[2]);
+
+                  cvatom_thr[j][0] += rjc[0] * Fj[0];
+                  cvatom_thr[j][1] += rjc[1] * Fj[1];
+                  cvatom_thr[j][2] += rjc[2] * Fj[2];
+                  cvatom_thr[j][3] += rjc[0] * Fj[1];
+                  cvatom_thr[j][4] += rjc[0] * Fj[2];
+                  cvatom_thr[j][5] += rjc[1] * Fj[2];
+                  cvatom_thr[j][6] += rjc[1] * Fj[0];
+                  cvatom_thr[j][7] += rjc[2] * Fj[0];
+                  cvatom_thr[j][8] += rjc[2] * Fj[1];
+
+                  double rkc[3];
+                  rkc[0] = THIRD * (del_rki[0] + del_rkj[0]);
+                  rkc[1] = THIRD * (del_rki[1] + del_rkj[1]);
+                  rkc[2] = THIRD * (del_rki[2] + del_rkj[2]);
+
+                  cvatom_thr[k][0] += rkc[0] * Fk[0];
+                  cvatom_thr[k][1] += rkc[1] * Fk[1];
+                  cvatom_thr[k][2] += rkc[2] * Fk[2];
+                  cvatom_thr[k][3] += rkc[0] * Fk[1];
+                  cvatom_thr[k][4] += rkc[0] * Fk[2];
+                  cvatom_thr[k][5] += rkc[1] * Fk[2];
+                  cvatom_thr[k][6] += rkc[1] * Fk[0];
+                  cvatom_thr[k][7] += rkc[2] * Fk[0];
+                  cvatom_thr[k][8] += rkc[2] * Fk[1];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairUF3OMP::memory_usage()
+{
+  double bytes = memory_usage_thr();
+  bytes += PairUF3::memory_usage();
+  bytes += (double) maxchunk * sizeof(int);          // chunk_start
+  bytes += (double) maxnumshort_ii * sizeof(int);    // numshort_ii
+
+  return bytes;
+}
@@ -0,0 +1,68 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida), 
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+// clang-format off
+PairStyle(uf3/omp,PairUF3OMP);
+// clang-format on
+#else
+
+#ifndef LMP_PAIR_UF3_OMP_H
+#define LMP_PAIR_UF3_OMP_H
+
+#include "pair_uf3.h"
+#include "thr_omp.h"
+
+namespace LAMMPS_NS {
+
+class PairUF3OMP : public PairUF3, public ThrOMP {
+
+ public:
+  PairUF3OMP(class LAMMPS *);
+  ~PairUF3OMP() override;
+
+  void compute(int, int) override;
+  double memory_usage() override;
+
+ protected:
+  int *chunk_start, nchunk, maxchunk;    // ilist boundaries of chunks with equal work
+  int *numshort_ii, maxnumshort_ii;      // size of 3-body short list of ilist[ii]
+                                         // during the previous step
+  void setup_chunks(int);
+
+  // thread private copies of the short list and 3-body scratch of PairUF3
+  struct ShortListThr {
+    int *neighshort, maxshort;
+    double *rshort, **delshort, **ushort;
+    uf3_axis_bases *ikshort;
+    std::vector<int> short_start, ikshort_jtype;
+    std::vector<uf3_slab> slab;
+    std::vector<int> slab_state;
+    std::vector<double> rcand;
+  };
+
+ private:
+  template <int EVFLAG, int EFLAG>
+  void eval(int iifrom, int iito, int rebuild_3b, ShortListThr &sthr, ThrData *const thr);
+};
+
+}    // namespace LAMMPS_NS
+
+#endif
+#endif
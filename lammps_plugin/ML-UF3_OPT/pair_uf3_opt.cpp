@@ -0,0 +1,524 @@
+/* ----------------------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida),
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#include "pair_uf3_opt.h"
+
+#include "atom.h"
+#include "force.h"
+#include "math_const.h"
+#include "memory.h"
+#include "neigh_list.h"
+#include "neighbor.h"
+
+#include <cmath>
+
+using namespace LAMMPS_NS;
+using namespace MathConst;
+
+/* ---------------------------------------------------------------------- */
+
+// rows of the per neighbor and per batch buffers
+enum { NDX, NDY, NDZ, NR, BR1, BR2, BR3, BE, BD1, BD2, BD3, BKJX, BKJY, BKJZ, NBATCH };
+enum { NJ, NTYPE, BIDX, NIBATCH };
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3Opt::PairUF3Opt(LAMMPS *lmp) : PairUF3(lmp)
+{
+  batch = nullptr;
+  ibatch = nullptr;
+  maxbatch = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+PairUF3Opt::~PairUF3Opt()
+{
+  if (copymode) return;
+  memory->destroy(batch);
+  memory->destroy(ibatch);
+}
+
+/* ----------------------------------------------------------------------
+   select the kernel once per step so that the pair and triplet loops
+   carry no runtime branches on the tally flags or the body order.
+   steps without energy/virial output skip the energy contractions.
+------------------------------------------------------------------------- */
+
+void PairUF3Opt::compute(int eflag, int vflag)
+{
+  ev_init(eflag, vflag);
+
+  const int cvflag = vflag_either && cvflag_atom;
+
+  if (pot_3b) {
+    if (evflag) {
+      if (eflag) {
+        if (cvflag) eval<1, 1, 1, 1>();
+        else eval<1, 1, 0, 1>();
+      } else {
+        if (cvflag) eval<1, 0, 1, 1>();
+        else eval<1, 0, 0, 1>();
+      }
+    } else eval<0, 0, 0, 1>();
+  } else {
+    if (evflag) {
+      if (eflag) {
+        if (cvflag) eval<1, 1, 1, 0>();
+        else eval<1, 1, 0, 0>();
+      } else {
+        if (cvflag) eval<1, 0, 1, 0>();
+        else eval<1, 0, 0, 0>();
+      }
+    } else eval<0, 0, 0, 0>();
+  }
+
+  if (vflag_fdotr) virial_fdotr_compute();
+}
+
+/* ----------------------------------------------------------------------
+   the neighbors of each atom are collected per type into batches that
+   are evaluated with one eval_batch() call on the spline of that type
+   pair (2-body) or triplet (3-body). the pairs come from the half list,
+   the triplets from the full list at the 3-body cutoffs.
+------------------------------------------------------------------------- */
+
+template <int EVFLAG, int EFLAG, int CVFLAG_ATOM, int POT_3B> void PairUF3Opt::eval()
+{
+  int i, j, k, ii, jj, kk, inum, jnum, itype, jtype, ktype;
+  double xtmp, ytmp, ztmp, delx, dely, delz, evdwl, fpair, fx, fy, fz;
+  double del_rji[3], del_rki[3], del_rkj[3];
+  double fij[3], fik[3], fjk[3];
+  double fji[3], fki[3], fkj[3];
+  double Fi[3], Fj[3], Fk[3];
+  double rsq, rij, rik, rjk;
+  int *ilist, *jlist, *numneigh, **firstneigh;
+
+  const dbl3_t *_noalias const x = (dbl3_t *) atom->x[0];
+  dbl3_t *_noalias const f = (dbl3_t *) atom->f[0];
+  const int *_noalias const type = atom->type;
+  const int nlocal = atom->nlocal;
+  const int newton_pair = force->newton_pair;
+
+  inum = list->inum;
+  ilist = list->ilist;
+  numneigh = list->numneigh;
+  firstneigh = list->firstneigh;
+
+  // loop over the half list neighbors of my atoms
+  for (ii = 0; ii < inum; ii++) {
+    evdwl = 0;
+    i = ilist[ii];
+    xtmp = x[i].x;
+    ytmp = x[i].y;
+    ztmp = x[i].z;
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+
+    if (jnum > maxbatch) grow_batch(jnum);
+    double *_noalias const ndx = batch[NDX];
+    double *_noalias const ndy = batch[NDY];
+    double *_noalias const ndz = batch[NDZ];
+    double *_noalias const nr = batch[NR];
+    double *_noalias const br1 = batch[BR1];
+    double *_noalias const be = EFLAG ? batch[BE] : nullptr;
+    double *_noalias const bd1 = batch[BD1];
+    int *_noalias const nj = ibatch[NJ];
+    int *_noalias const ntype = ibatch[NTYPE];
+    int *_noalias const bidx = ibatch[BIDX];
+
+    // neighbors within the 2-body cutoff
+    int ncut = 0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j].x;
+      dely = ytmp - x[j].y;
+      delz = ztmp - x[j].z;
+
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      if (rsq < cutsq[itype][jtype]) {
+        nj[ncut] = j;
+        ntype[ncut] = jtype;
+        ndx[ncut] = delx;
+        ndy[ncut] = dely;
+        ndz[ncut] = delz;
+        nr[ncut] = sqrt(rsq);
+        ncut++;
+      }
+    }
+
+    // 2-body interaction, one batch per neighbor type. the UF3 2-body
+    // energy is a sum over ordered pairs, so each pair counts twice
+    for (jtype = 1; jtype <= num_of_elements; jtype++) {
+      int nbatch = 0;
+      for (int n = 0; n < ncut; n++) {
+        if (ntype[n] != jtype) continue;
+        bidx[nbatch] = n;
+        br1[nbatch] = nr[n];
+        nbatch++;
+      }
+      if (!nbatch) continue;
+
+      UFBS2b[itype][jtype]->eval_batch(br1, nbatch, be, bd1);
+
+      for (int b = 0; b < nbatch; b++) {
+        const int n = bidx[b];
+        j = nj[n];
+        delx = ndx[n];
+        dely = ndy[n];
+        delz = ndz[n];
+
+        fpair = -2 * bd1[b] / br1[b];
+
+        fx = delx * fpair;
+        fy = dely * fpair;
+        fz = delz * fpair;
+
+        f[i].x += fx;
+        f[i].y += fy;
+        f[i].z += fz;
+        f[j].x -= fx;
+        f[j].y -= fy;
+        f[j].z -= fz;
+
+        if (EFLAG) evdwl = 2 * be[b];
+
+        if (EVFLAG) {
+          ev_tally_xyz(i, j, nlocal, newton_pair, evdwl, 0.0, fx, fy, fz, delx, dely, delz);
+
+          // Centroid Stress
+          if (CVFLAG_ATOM) {
+            double v[6];
+
+            v[0] = delx * fx;
+            v[1] = dely * fy;
+            v[2] = delz * fz;
+            v[3] = delx * fy;
+            v[4] = delx * fz;
+            v[5] = dely * fz;
+
+            cvatom[i][0] += 0.5 * v[0];
+            cvatom[i][1] += 0.5 * v[1];
+            cvatom[i][2] += 0.5 * v[2];
+            cvatom[i][3] += 0.5 * v[3];
+            cvatom[i][4] += 0.5 * v[4];
+            cvatom[i][5] += 0.5 * v[5];
+            cvatom[i][6] += 0.5 * v[3];
+            cvatom[i][7] += 0.5 * v[4];
+            cvatom[i][8] += 0.5 * v[5];
+
+            cvatom[j][0] += 0.5 * v[0];
+            cvatom[j][1] += 0.5 * v[1];
+            cvatom[j][2] += 0.5 * v[2];
+            cvatom[j][3] += 0.5 * v[3];
+            cvatom[j][4] += 0.5 * v[4];
+            cvatom[j][5] += 0.5 * v[5];
+            cvatom[j][6] += 0.5 * v[3];
+            cvatom[j][7] += 0.5 * v[4];
+            cvatom[j][8] += 0.5 * v[5];
+          }
+        }
+      }
+    }
+
+  }
+
+  if (!POT_3B) return;
+
+  // candidates of the 3-body loop with the persist keyword, see PairUF3
+  const int rebuild_3b = persist_3b && ((neighbor->ago == 0) || !pshort_ready);
+  if (rebuild_3b) setup_candidates_3b();
+
+  inum = list_3b->inum;
+  ilist = list_3b->ilist;
+  numneigh = list_3b->numneigh;
+  firstneigh = list_3b->firstneigh;
+
+  // loop over the 3-body full list neighbors of my atoms
+  for (ii = 0; ii < inum; ii++) {
+    evdwl = 0;
+    i = ilist[ii];
+    xtmp = x[i].x;
+    ytmp = x[i].y;
+    ztmp = x[i].z;
+    itype = type[i];
+    jlist = firstneigh[i];
+    jnum = numneigh[i];
+    if (persist_3b) {
+      if (rebuild_3b)
+        pshort_num[ii] = collect_candidates_3b(i, jlist, jnum, pshort + pshort_start[ii], rcand_3b);
+      jlist = pshort + pshort_start[ii];
+      jnum = pshort_num[ii];
+    }
+
+    if (jnum > maxbatch) grow_batch(jnum);
+    double *_noalias const ndx = batch[NDX];
+    double *_noalias const ndy = batch[NDY];
+    double *_noalias const ndz = batch[NDZ];
+    double *_noalias const nr = batch[NR];
+    double *_noalias const br1 = batch[BR1];
+    double *_noalias const br2 = batch[BR2];
+    double *_noalias const br3 = batch[BR3];
+    double *_noalias const be = EFLAG ? batch[BE] : nullptr;
+    double *_noalias const bd1 = batch[BD1];
+    double *_noalias const bd2 = batch[BD2];
+    double *_noalias const bd3 = batch[BD3];
+    double *_noalias const bkjx = batch[BKJX];
+    double *_noalias const bkjy = batch[BKJY];
+    double *_noalias const bkjz = batch[BKJZ];
+    int *_noalias const nj = ibatch[NJ];
+    int *_noalias const ntype = ibatch[NTYPE];
+    int *_noalias const bidx = ibatch[BIDX];
+
+    // short list of the neighbors within the 3-body list cutoff, grouped
+    // by type and sorted by distance within each group, so that every
+    // ktype batch below is a contiguous run that ends at the ik cutoff
+    int numshort = 0;
+    for (jj = 0; jj < jnum; jj++) {
+      j = jlist[jj];
+      j &= NEIGHMASK;
+
+      delx = xtmp - x[j].x;
+      dely = ytmp - x[j].y;
+      delz = ztmp - x[j].z;
+
+      rsq = delx * delx + dely * dely + delz * delz;
+      jtype = type[j];
+      if (rsq < cutsq[itype][jtype]) {
+        rij = sqrt(rsq);
+        if (rij > cut_3b_list[itype][jtype]) continue;
+        int n = numshort;
+        while ((n > 0) &&
+               ((ntype[n - 1] > jtype) || ((ntype[n - 1] == jtype) && (nr[n - 1] > rij)))) {
+          nj[n] = nj[n - 1];
+          ntype[n] = ntype[n - 1];
+          ndx[n] = ndx[n - 1];
+          ndy[n] = ndy[n - 1];
+          ndz[n] = ndz[n - 1];
+          nr[n] = nr[n - 1];
+          n--;
+        }
+        nj[n] = j;
+        ntype[n] = jtype;
+        ndx[n] = delx;
+        ndy[n] = dely;
+        ndz[n] = delz;
+        nr[n] = rij;
+        numshort++;
+      }
+    }
+
+    // start of the ktype group in the short list
+    int nstart = 0;
+    for (ktype = 1; ktype <= num_of_elements + 1; ktype++) {
+      while ((nstart < numshort) && (ntype[nstart] < ktype)) nstart++;
+      short_start[ktype] = nstart;
+    }
+
+    // 3-body interaction
+    // jth atom
+    const int numshort_1 = numshort - 1;
+    for (jj = 0; jj < numshort_1; jj++) {
+      j = nj[jj];
+      jtype = ntype[jj];
+      del_rji[0] = -ndx[jj];
+      del_rji[1] = -ndy[jj];
+      del_rji[2] = -ndz[jj];
+      rij = nr[jj];
+
+      // kth atoms, one batch per type. the groups of the types before
+      // jtype only hold neighbors that come before j
+      for (ktype = jtype; ktype <= num_of_elements; ktype++) {
+        const int id = id_3b(itype, jtype, ktype);
+        const uf3_interaction_3b &inter = interactions_3b[id];
+        if ((rij > inter.cut[2]) || (rij < inter.min_cut[2])) continue;
+        const double cutik = inter.cut[1];
+        const double minik = inter.min_cut[1];
+        const double minjk = inter.min_cut[0];
+        const double cutjk = inter.cut[0];
+
+        // rjk >= |rik - rij| bounds the k that can be within cutjk
+        int kbegin = (ktype == jtype) ? jj + 1 : short_start[ktype];
+        const int kend = short_start[ktype + 1];
+        while ((kbegin < kend) && (nr[kbegin] < rij - cutjk)) kbegin++;
+        const double rikmax = MIN(cutik, rij + cutjk);
+        int nbatch = 0;
+        for (kk = kbegin; kk < kend; kk++) {
+          rik = nr[kk];
+          if (rik > rikmax) break;
+          if (rik < minik) continue;
+
+          k = nj[kk];
+          del_rkj[0] = x[k].x - x[j].x;
+          del_rkj[1] = x[k].y - x[j].y;
+          del_rkj[2] = x[k].z - x[j].z;
+          rjk = sqrt(
+              ((del_rkj[0] * del_rkj[0]) + (del_rkj[1] * del_rkj[1]) + (del_rkj[2] * del_rkj[2])));
+          if ((rjk < minjk) || (rjk > cutjk)) continue;
+
+          bidx[nbatch] = kk;
+          br1[nbatch] = rij;
+          br2[nbatch] = rik;
+          br3[nbatch] = rjk;
+          bkjx[nbatch] = del_rkj[0];
+          bkjy[nbatch] = del_rkj[1];
+          bkjz[nbatch] = del_rkj[2];
+          nbatch++;
+        }
+        if (!nbatch) continue;
+
+        bsplines_3b[id].eval_batch(br1, br2, br3, nbatch, be, bd1, bd2, bd3);
+
+        for (int b = 0; b < nbatch; b++) {
+          const int n = bidx[b];
+          k = nj[n];
+          del_rki[0] = -ndx[n];
+          del_rki[1] = -ndy[n];
+          del_rki[2] = -ndz[n];
+          del_rkj[0] = bkjx[b];
+          del_rkj[1] = bkjy[b];
+          del_rkj[2] = bkjz[b];
+          rik = br2[b];
+          rjk = br3[b];
+
+          fij[0] = bd1[b] * (del_rji[0] / rij);
+          fji[0] = -fij[0];
+          fik[0] = bd2[b] * (del_rki[0] / rik);
+          fki[0] = -fik[0];
+          fjk[0] = bd3[b] * (del_rkj[0] / rjk);
+          fkj[0] = -fjk[0];
+
+          fij[1] = bd1[b] * (del_rji[1] / rij);
+          fji[1] = -fij[1];
+          fik[1] = bd2[b] * (del_rki[1] / rik);
+          fki[1] = -fik[1];
+          fjk[1] = bd3[b] * (del_rkj[1] / rjk);
+          fkj[1] = -fjk[1];
+
+          fij[2] = bd1[b] * (del_rji[2] / rij);
+          fji[2] = -fij[2];
+          fik[2] = bd2[b] * (del_rki[2] / rik);
+          fki[2] = -fik[2];
+          fjk[2] = bd3[b] * (del_rkj[2] / rjk);
+          fkj[2] = -fjk[2];
+
+          Fi[0] = fij[0] + fik[0];
+          Fi[1] = fij[1] + fik[1];
+          Fi[2] = fij[2] + fik[2];
+          f[i].x += Fi[0];
+          f[i].y += Fi[1];
+          f[i].z += Fi[2];
+
+          Fj[0] = fji[0] + fjk[0];
+          Fj[1] = fji[1] + fjk[1];
+          Fj[2] = fji[2] + fjk[2];
+          f[j].x += Fj[0];
+          f[j].y += Fj[1];
+          f[j].z += Fj[2];
+
+          Fk[0] = fki[0] + fkj[0];
+          Fk[1] = fki[1] + fkj[1];
+          Fk[2] = fki[2] + fkj[2];
+          f[k].x += Fk[0];
+          f[k].y += Fk[1];
+          f[k].z += Fk[2];
+
+          if (EFLAG) evdwl = be[b];
+
+          if (EVFLAG) {
+            ev_tally3(i, j, k, evdwl, 0, Fj, Fk, del_rji, del_rki);
+
+            // Centroid stress 3-body term
+            if (CVFLAG_ATOM) {
+              double ric[3];
+              ric[0] = THIRD * (-del_rji[0] - del_rki[0]);
+              ric[1] = THIRD * (-del_rji[1] - del_rki[1]);
+              ric[2] = THIRD * (-del_rji[2] - del_rki[2]);
+
+              cvatom[i][0] += ric[0] * Fi[0];
+              cvatom[i][1] += ric[1] * Fi[1];
+              cvatom[i][2] += ric[2] * Fi[2];
+              cvatom[i][3] += ric[0] * Fi[1];
+              cvatom[i][4] += ric[0] * Fi[2];
+              cvatom[i][5] += ric[1] * Fi[2];
+              cvatom[i][6] += ric[1] * Fi[0];
+              cvatom[i][7] += ric[2] * Fi[0];
+              cvatom[i][8] += ric[2] * Fi[1];
+
+              double rjc[3];
+              rjc[0] = THIRD * (del_rji[0] - del_rkj[0]);
+              rjc[1] = THIRD * (del_rji[1] - del_rkj[1]);
+              rjc[2] = THIRD * (del_rji[2] - del_rkj[2]);
+
+              cvatom[j][0] += rjc[0] * Fj[0];
+              cvatom[j][1] += rjc[1] * Fj[1];
+              cvatom[j][2] += rjc[2] * Fj[2];
+              cvatom[j][3] += rjc[0] * Fj[1];
+              cvatom[j][4] += rjc[0] * Fj[2];
+              cvatom[j][5] += rjc[1] * Fj[2];
+              cvatom[j][6] += rjc[1] * Fj[0];
+              cvatom[j][7] += rjc[2] * Fj[0];
+              cvatom[j][8] += rjc[2] * Fj[1];
+
+              double rkc[3];
+              rkc[0] = THIRD * (del_rki[0] + del_rkj[0]);
+              rkc[1] = THIRD * (del_rki[1] + del_rkj[1]);
+              rkc[2] = THIRD * (del_rki[2] + del_rkj[2]);
+
+              cvatom[k][0] += rkc[0] * Fk[0];
+              cvatom[k][1] += rkc[1] * Fk[1];
+              cvatom[k][2] += rkc[2] * Fk[2];
+              cvatom[k][3] += rkc[0] * Fk[1];
+              cvatom[k][4] += rkc[0] * Fk[2];
+              cvatom[k][5] += rkc[1] * Fk[2];
+              cvatom[k][6] += rkc[1] * Fk[0];
+              cvatom[k][7] += rkc[2] * Fk[0];
+              cvatom[k][8] += rkc[2] * Fk[1];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+
+void PairUF3Opt::grow_batch(int n)
+{
+  maxbatch = n;
+  memory->destroy(batch);
+  memory->destroy(ibatch);
+  memory->create(batch, NBATCH, maxbatch, "pair:batch");
+  memory->create(ibatch, NIBATCH, maxbatch, "pair:ibatch");
+}
+
+/* ---------------------------------------------------------------------- */
+
+double PairUF3Opt::memory_usage()
+{
+  double bytes = PairUF3::memory_usage();
+  bytes += (double) NBATCH * maxbatch * sizeof(double);
+  bytes += (double) NIBATCH * maxbatch * sizeof(int);
+  return bytes;
+}
@@ -0,0 +1,52 @@
+/* -*- c++ -*- ----------------------------------------------------------
+   LAMMPS - Large-scale Atomic/Molecular Massively Parallel Simulator
+   https://www.lammps.org/, Sandia National Laboratories
+   Steve Plimpton, sjplimp@sandia.gov
+
+   Copyright (2003) Sandia Corporation.  Under the terms of Contract
+   DE-AC04-94AL85000 with Sandia Corporation, the U.S. Government retains
+   certain rights in this software.  This software is distributed under
+   the GNU General Public License.
+
+   See the README file in the top-level LAMMPS directory.
+------------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------
+ *    Contributing authors: Ajinkya Hire (U of Florida), 
+ *                          Hendrik Kraß (U of Constance),
+ *                          Richard Hennig (U of Florida)
+ * ---------------------------------------------------------------------- */
+
+#ifdef PAIR_CLASS
+// clang-format off
+PairStyle(uf3/opt,PairUF3Opt);
+// clang-format on
+#else
+
+#ifndef LMP_PAIR_UF3_OPT_H
+#define LMP_PAIR_UF3_OPT_H
+
+#include "pair_uf3.h"
+
+namespace LAMMPS_NS {
+
+class PairUF3Opt : public PairUF3 {
+ public:
+  PairUF3Opt(class LAMMPS *);
+  ~PairUF3Opt() override;
+  void compute(int, int) override;
+  double memory_usage() override;
+
+ protected:
+  double **batch;    // per neighbor and per batch buffers
+  int **ibatch;
+  int maxbatch;
+  void grow_batch(int);
+
+  template <int EVFLAG, int EFLAG, int CVFLAG_ATOM, int POT_3B> void eval();
+};
+
+}    // namespace LAMMPS_NS
+
+#endif
+#endif
@@ -5,19 +5,27 @@ from uf3.data import composition
 import numpy as np
 import os, sys
 
-if len(sys.argv) != 3:
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import uf3_pot_binary
+
+# optional --binary also writes the binary potential files
+write_binary = "--binary" in sys.argv[1:]
+args = [a for a in sys.argv[1:] if a != "--binary"]
+
+if len(args) != 2:
     #raise ValueError("Invalid number of arguments. Enter name of the structure\n\
     #        file readable by pymatgen, UF3 model file, and name \n\
     #        directory to write the UF3 potential files")
     raise ValueError("Invalid number of arguments. Enter UF3 model file and name\n\
-            of directory to write the UF3 potential files")
+            of directory to write the UF3 potential files, optionally followed\n\
+            by --binary")
 
 #struct = Structure.from_file(sys.argv[1])
-model = least_squares.WeightedLinearModel.from_json(sys.argv[1])
+model = least_squares.WeightedLinearModel.from_json(args[0])
 
 #struct_elements = set(struct.symbol_set)
 model_elements = set(model.bspline_config.chemical_system.element_list)
-pot_dir = sys.argv[2]
+pot_dir = args[1]
 
 def create_element_map_for_lammps(uf3_chem_sys):
     """Returns dict
@@ -94,17 +102,24 @@ def write_lammps_ip_struct(struct_obj,element_map):
     fp.close()
     return w_filename
 """
-def write_uf3_lammps_pot_files(chemical_sys,model,pot_dir):
+def write_uf3_lammps_pot_files(chemical_sys,model,pot_dir,binary=False):
     """Returns list
 
     Creates and writes UF3 lammps potential files. Takes UF3 composition object,
     UF3 model and name of potential directory as input. Will overwrite the files
-    if files with the same exists
+    if files with the same exists. With binary=True the binary potential files
+    (see uf3_pot_binary.py) are written as well, with the .uf3b suffix
     """
     overwrite = True
     if not os.path.exists(pot_dir):
         os.mkdir(pot_dir)
     files = {}
+    binary_pots = {}
+    if model.bspline_config.knot_strategy == 'linear':
+        knot_spacing = "uk"
+    else:
+        knot_spacing = "nk"
+    trims = (model.bspline_config.leading_trim, model.bspline_config.trailing_trim)
 
     for interaction in chemical_sys.interactions_map[2]:
         key = '_'.join(interaction)
@@ -130,6 +145,12 @@ def write_uf3_lammps_pot_files(chemical_sys,model,pot_dir):
 
         files[key] += "#"
 
+        binary_pots[key] = dict(nbody=2, leading_trim=trims[0], trailing_trim=trims[1],
+                knot_spacing=knot_spacing,
+                cuts=[model.bspline_config.r_max_map[interaction]],
+                knots=[model.bspline_config.knots_map[interaction]], shape=[length],
+                coeff=model.coefficients[start_index:start_index + length])
+
     if 3 in model.bspline_config.interactions_map:
         for interaction in model.bspline_config.interactions_map[3]:
             key = '_'.join(interaction)
@@ -172,11 +193,20 @@ def write_uf3_lammps_pot_files(chemical_sys,model,pot_dir):
                     
             files[key] += "#"
 
+            binary_pots[key] = dict(nbody=3, leading_trim=trims[0], trailing_trim=trims[1],
+                    knot_spacing=knot_spacing,
+                    cuts=[model.bspline_config.r_max_map[interaction][a] for a in (2, 1, 0)],
+                    knots=[model.bspline_config.knots_map[interaction][a] for a in (2, 1, 0)],
+                    shape=list(decompressed.shape), coeff=decompressed.ravel())
+
     for k, v in files.items():
         if not overwrite and os.path.exists(pot_dir + k):
             continue
         with open(pot_dir +"/"+ k, "w") as f:
             f.write(v)
+        if binary:
+            uf3_pot_binary.write_binary_pot(pot_dir + "/" + k + uf3_pot_binary.SUFFIX,
+                    **binary_pots[k])
     return files.keys()
 
 """
@@ -208,7 +238,8 @@ else:
 
 chemical_sys = model.bspline_config.chemical_system
 
-pot_files = write_uf3_lammps_pot_files(chemical_sys=chemical_sys,model=model,pot_dir=pot_dir)
+pot_files = write_uf3_lammps_pot_files(chemical_sys=chemical_sys,model=model,pot_dir=pot_dir,
+        binary=write_binary)
 pot_files = list(pot_files)
 lines = "pair_style uf3 %i %i"%(model.bspline_config.degree,len(chemical_sys.element_list))
 
@@ -0,0 +1,124 @@
+"""Binary UF3 LAMMPS potential files.
+
+Converts '#UF3 POT' text files to the binary format read by pair_style uf3
+(see ML-UF3/uf3_binary_pot.h). The binary files hold the same data and are
+mapped by LAMMPS instead of being parsed.
+
+Usage-
+    python uf3_pot_binary.py [-o OUT_DIR] POT_FILE [POT_FILE ...]
+
+writes POT_FILE.uf3b next to every POT_FILE, or into OUT_DIR.
+"""
+import argparse
+import os
+import struct
+import sys
+from array import array
+
+MAGIC = b"UF3BPOT\0"
+VERSION = 1
+ALIGN = 64
+SUFFIX = ".uf3b"
+
+# magic, version, nbody, leading_trim, trailing_trim, knot_spacing, reserved,
+# cut[3], nknots[3], shape[3], knots_offset[3], coeff_offset, file_size
+HEADER = struct.Struct("<8s6I3d3Q3Q3Q2Q")
+
+
+def _aligned(offset):
+    return (offset + ALIGN - 1) // ALIGN * ALIGN
+
+
+def _doubles(values):
+    data = array("d", (float(v) for v in values))
+    if sys.byteorder != "little":
+        data.byteswap()
+    return data.tobytes()
+
+
+def write_binary_pot(path, nbody, leading_trim, trailing_trim, knot_spacing, cuts, knots,
+                     shape, coeff):
+    """Writes a binary UF3 potential file
+
+    nbody is 2 or 3, knot_spacing 'uk' or 'nk'. For 2-body potentials cuts,
+    knots and shape have one entry, for 3-body potentials cuts and knots are
+    ordered jk, ik, ij as in the text files and shape is the shape of the
+    [ij][ik][jk] coefficient tensor. coeff is flat, jk running fastest.
+    """
+    naxes = 1 if nbody == 2 else 3
+    if len(cuts) != naxes or len(knots) != naxes or len(shape) != naxes:
+        raise ValueError("expected %i cutoffs, knot vectors and dimensions" % naxes)
+    blocks = [_doubles(k) for k in knots] + [_doubles(coeff)]
+    ncoeff = 1
+    for n in shape:
+        ncoeff *= n
+    if len(blocks[-1]) != 8 * ncoeff:
+        raise ValueError("expected %i coefficients, found %i" % (ncoeff, len(blocks[-1]) // 8))
+
+    offsets = []
+    offset = _aligned(HEADER.size)
+    for b in blocks:
+        offsets.append(offset)
+        offset = _aligned(offset + len(b))
+    file_size = offsets[-1] + len(blocks[-1])
+
+    pad3 = lambda v, fill: list(v) + [fill] * (3 - len(v))
+    header = HEADER.pack(MAGIC, VERSION, nbody, leading_trim, trailing_trim,
+                         0 if knot_spacing == "uk" else 1, 0,
+                         *pad3(cuts, 0.0), *pad3([len(k) for k in knots], 0),
+                         *pad3(shape, 0), *pad3(offsets[:-1], 0), offsets[-1], file_size)
+    with open(path, "wb") as f:
+        f.write(header)
+        for offset, b in zip(offsets, blocks):
+            f.write(b"\0" * (offset - f.tell()))
+            f.write(b)
+
+
+def read_text_pot(path):
+    """Returns the content of a '#UF3 POT' text file as a dict"""
+    with open(path) as f:
+        lines = [l.split() for l in f]
+    if lines[0][:2] != ["#UF3", "POT"]:
+        raise ValueError("%s is not a UF3 POT file" % path)
+    nbody, leading_trim, trailing_trim, knot_spacing = lines[1]
+    if nbody not in ("2B", "3B"):
+        raise ValueError("%s: expected 2B or 3B, found %s" % (path, nbody))
+    pot = {"nbody": int(nbody[0]), "leading_trim": int(leading_trim),
+           "trailing_trim": int(trailing_trim), "knot_spacing": knot_spacing}
+    if pot["nbody"] == 2:
+        pot["cuts"] = [float(lines[2][0])]
+        pot["knots"] = [[float(v) for v in lines[3]]]
+        pot["shape"] = [int(lines[4][0])]
+        pot["coeff"] = [float(v) for v in lines[5]]
+    else:
+        pot["cuts"] = [float(v) for v in lines[2][:3]]
+        pot["knots"] = [[float(v) for v in lines[3 + a]] for a in range(3)]
+        pot["shape"] = [int(v) for v in lines[6]]
+        nrows = pot["shape"][0] * pot["shape"][1]
+        pot["coeff"] = [float(v) for l in lines[7:7 + nrows] for v in l]
+    for k, n in zip(pot["knots"], [int(v) for v in lines[2][len(pot["cuts"]):]]):
+        if len(k) != n:
+            raise ValueError("%s: expected %i knots, found %i" % (path, n, len(k)))
+    return pot
+
+
+def convert(path, out_path):
+    write_binary_pot(out_path, **read_text_pot(path))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert UF3 LAMMPS potential files to binary")
+    parser.add_argument("files", nargs="+", help="'#UF3 POT' text files")
+    parser.add_argument("-o", "--out-dir", help="directory for the binary files")
+    args = parser.parse_args()
+    for path in args.files:
+        out_dir = args.out_dir or os.path.dirname(path) or "."
+        if not os.path.exists(out_dir):
+            os.makedirs(out_dir)
+        out_path = os.path.join(out_dir, os.path.basename(path) + SUFFIX)
+        convert(path, out_path)
+        print("%s -> %s" % (path, out_path))
+
+
+if __name__ == "__main__":
+    main()